@@ -19,11 +19,19 @@ void MainWindow::buildResultList() {
   
   bool ok;
   QString t_last;
+  QStringList steps;
   
   while(sim.getTrackNext() >= 0) {
-    ui.ResultList->addItem(sim.getTrackT());
-    if(sim.getTrackT().toDouble(&ok) > 0.00000001)
-      if(ok) t_last = sim.getTrackT();
+    steps << sim.getTrackT();
+  }
+
+  /* list only timesteps with results, whole or in pieces */
+  foreach(QString t, steps) {
+    if(!QFile::exists(sim.getResultFile("vof", sim.getTrackN(t)))) continue;
+
+    ui.ResultList->addItem(t);
+    if(t.toDouble(&ok) > 0.00000001)
+      if(ok) t_last = t;
   }
 
   if(t_last.toDouble(&ok) > 0.0000001)
@@ -132,7 +140,7 @@ void MainWindow::on_Paraview_clicked() {
     foreach(QListWidgetItem *item, ui.ResultList->selectedItems()) {
       index = sim.getTrackN(item->text());
       timestep = item->text();
-      out << "<DataSet timestep=\"" << timestep << "\" file=\"vtk/U_" << index << ".vti\" />\n";
+      out << "<DataSet timestep=\"" << timestep << "\" file=\"" << sim.getResultFile("U", index) << "\" />\n";
     }
     out << "</Collection>\n";
     out << "</VTKFile>\n";
@@ -148,7 +156,7 @@ void MainWindow::on_Paraview_clicked() {
     foreach(QListWidgetItem *item, ui.ResultList->selectedItems()) {
       index = sim.getTrackN(item->text());
       timestep = item->text();
-      out << "<DataSet timestep=\"" << timestep << "\" file=\"vtk/P_" << index << ".vti\" />\n";
+      out << "<DataSet timestep=\"" << timestep << "\" file=\"" << sim.getResultFile("P", index) << "\" />\n";
     }
     out << "</Collection>\n";
     out << "</VTKFile>\n";
@@ -164,7 +172,7 @@ void MainWindow::on_Paraview_clicked() {
     foreach(QListWidgetItem *item, ui.ResultList->selectedItems()) {
       index = sim.getTrackN(item->text());
       timestep = item->text();
-      out << "<DataSet timestep=\"" << timestep << "\" file=\"vtk/vof_" << index << ".vti\" />\n";
+      out << "<DataSet timestep=\"" << timestep << "\" file=\"" << sim.getResultFile("vof", index) << "\" />\n";
     }
     out << "</Collection>\n";
     out << "</VTKFile>\n";
@@ -180,7 +188,7 @@ void MainWindow::on_Paraview_clicked() {
     foreach(QListWidgetItem *item, ui.ResultList->selectedItems()) {
       index = sim.getTrackN(item->text());
       timestep = item->text();
-      out << "<DataSet timestep=\"" << timestep << "\" file=\"vtk/vorticity_" << index << ".vti\" />\n";
+      out << "<DataSet timestep=\"" << timestep << "\" file=\"" << sim.getResultFile("vorticity", index) << "\" />\n";
     }
     out << "</Collection>\n";
     out << "</VTKFile>\n";
@@ -198,7 +206,7 @@ void MainWindow::on_Paraview_clicked() {
       foreach(QListWidgetItem *item, ui.ResultList->selectedItems()) {
         index = sim.getTrackN(item->text());
         timestep = item->text();
-        out << "<DataSet timestep=\"" << timestep << "\" file=\"vtk/k_" << index << ".vti\" />\n";
+        out << "<DataSet timestep=\"" << timestep << "\" file=\"" << sim.getResultFile("k", index) << "\" />\n";
       }
       out << "</Collection>\n";
       out << "</VTKFile>\n";
@@ -214,7 +222,7 @@ void MainWindow::on_Paraview_clicked() {
       foreach(QListWidgetItem *item, ui.ResultList->selectedItems()) {
         index = sim.getTrackN(item->text());
         timestep = item->text();
-        out << "<DataSet timestep=\"" << timestep << "\" file=\"vtk/E_" << index << ".vti\" />\n";
+        out << "<DataSet timestep=\"" << timestep << "\" file=\"" << sim.getResultFile("E", index) << "\" />\n";
       }
       out << "</Collection>\n";
       out << "</VTKFile>\n";
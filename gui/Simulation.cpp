@@ -901,6 +901,15 @@ bool removeDir(const QString & dirName)
     return result;
 }
  
+/* a parallel run writes each result in pieces with a .pvti master, 
+ * a single process writes the whole .vti */
+QString Simulation::getResultFile(QString name, QString n) {
+  QString file = "vtk/" + name + "_" + n;
+
+  if(QFile::exists(file + ".pvti")) return file + ".pvti";
+  return file + ".vti";
+}
+
 bool Simulation::deleteTrack(QString t) {
 	int n = getTrackN(t).toInt();
 	if(n == -1) return false;
@@ -910,7 +919,10 @@ bool Simulation::deleteTrack(QString t) {
 		removeDir(getPath() + "/" + t);
 				
 		QDir dir(getPath() + "/vtk");
-		dir.setNameFilters(QStringList() << "*_" + QString::number(n) + ".vtk");
+		dir.setNameFilters(QStringList() << "*_" + QString::number(n) + ".vtk"
+		                                 << "*_" + QString::number(n) + ".vti"
+		                                 << "*_" + QString::number(n) + ".pvti"
+		                                 << "*_" + QString::number(n) + "_*.vti");
 		dir.setFilter(QDir::Files);
 		foreach(QString dirFile, dir.entryList())
 		{
@@ -164,6 +164,7 @@ public:
   QString getTrackT();
   void trackRewind();
   QString getTrackN(QString str);
+  QString getResultFile(QString name, QString n);
   bool deleteTrack(QString t);
   
 
@@ -210,25 +210,22 @@ void MainWindow::visualizeRender() {
   QListWidgetItem *item = ui.timesteps->currentItem();
   if(item == NULL) return;
 
-  QString vtkFile = QString(sim.getTrackN(item->text()) + ".vti");
-  QString vectFile, volFile;
-
-  vectFile = vtkFile;
+  QString n = sim.getTrackN(item->text());
+  QString vtkFile, vectFile, volFile;
 
   if(ui.contourVOF->isChecked()) {
-    vtkFile.prepend("vof_");
+    vtkFile = sim.getResultFile("vof", n);
   } else if(ui.contourP->isChecked()) {
-    vtkFile.prepend("P_");
+    vtkFile = sim.getResultFile("P", n);
   } else if(ui.contourK->isChecked()) {
-    vtkFile.prepend("k_");
+    vtkFile = sim.getResultFile("k", n);
   } else if(ui.contourVorticity->isChecked()) {
-    vtkFile.prepend("vorticity_");
+    vtkFile = sim.getResultFile("vorticity", n);
   } else {
-    vtkFile.prepend("U_");
+    vtkFile = sim.getResultFile("U", n);
   }
-  vectFile.prepend("vtk/U_");
+  vectFile = sim.getResultFile("U", n);
   volFile = "vtk/fv_0.vti";
-  vtkFile.prepend("vtk/");
 
   origin = ui.originText->text().toDouble();
 
@@ -189,7 +189,7 @@ void MainWindow::visualize3dRender() {
     QListWidgetItem *item = ui.timesteps3d->currentItem();
 
     QString vtkFile;
-    vtkFile = QString("vtk/vof_" + sim.getTrackN(item->text()) + ".vti");
+    vtkFile = sim.getResultFile("vof", sim.getTrackN(item->text()));
     
   
     QString volFile; 
@@ -107,9 +107,7 @@ void Visualize3DDisplay::contour3d(QString vtkFile, int normal, double origin, d
   if(!QFile::exists(vtkFile)) return;
 
 	iso3dReader = NULL;
-  iso3dReader = vtkSmartPointer<vtkXMLImageDataReader>::New();
-  iso3dReader->SetFileName(vtkFile.toStdString().c_str());
-  iso3dReader->Update();
+  iso3dReader = openResult(vtkFile);
 
   vtkSmartPointer<vtkPlane> planePos = vtkSmartPointer<vtkPlane>::New();
   vtkSmartPointer<vtkPlane> planeNeg = vtkSmartPointer<vtkPlane>::New();
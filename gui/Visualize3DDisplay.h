@@ -56,7 +56,7 @@ private:
   vtkSmartPointer<vtkVolume> volume3d;
   vtkSmartPointer<vtkXMLImageDataReader> vol3dReader;
   vtkSmartPointer<vtkSmartVolumeMapper> vol3dMapper;
-  vtkSmartPointer<vtkXMLImageDataReader> iso3dReader;
+  vtkSmartPointer<vtkXMLReader> iso3dReader;
   vtkSmartPointer<vtkContourFilter> iso3dFilter;
   vtkSmartPointer<vtkPolyDataMapper> iso3dMapper;
   vtkSmartPointer<vtkActor> iso3dActor;
@@ -21,6 +21,19 @@ VisualizeDisplay::VisualizeDisplay(long int imax, long int jmax, long int kmax)
   VTKactor = NULL;
 } 
 
+/* results are written whole to a .vti, or by a parallel run as one piece 
+ * per process tied together by a .pvti */
+vtkSmartPointer<vtkXMLReader> VisualizeDisplay::openResult(QString vtkFile) {
+  vtkSmartPointer<vtkXMLReader> resultReader;
+
+  if(vtkFile.endsWith(".pvti")) resultReader = vtkSmartPointer<vtkXMLPImageDataReader>::New();
+  else resultReader = vtkSmartPointer<vtkXMLImageDataReader>::New();
+  resultReader->SetFileName(vtkFile.toStdString().c_str());
+  resultReader->Update();
+
+  return resultReader;
+}
+
 void VisualizeDisplay::block(QString vtkFile, int normal, double origin, double del) {
   
   RemoveVolume(volume);
@@ -145,9 +158,7 @@ void VisualizeDisplay::clip(QString vtkFile, int normal, double origin) {
   if(!QFile::exists(vtkFile)) return;
 
 	reader = NULL;
- 	reader = vtkSmartPointer<vtkXMLImageDataReader>::New();
-  reader->SetFileName(vtkFile.toStdString().c_str());
-  reader->Update();
+ 	reader = openResult(vtkFile);
 
 	geometryFilter = NULL;
   geometryFilter =
@@ -196,7 +207,7 @@ void VisualizeDisplay::clip(QString vtkFile, int normal, double origin) {
   VTKmapper->SetInputConnection(geometryFilter->GetOutputPort());
   VTKmapper->SetLookupTable(lut);
   //VTKmapper->UseLookupTableScalarRangeOff();
-  VTKmapper->SetScalarRange(reader->GetOutput()->GetScalarRange());
+  VTKmapper->SetScalarRange(reader->GetOutputAsDataSet()->GetScalarRange());
 
   VTKactor->SetMapper(VTKmapper);
 
@@ -217,9 +228,7 @@ void VisualizeDisplay::clipVector(QString vtkFile, int normal, double origin, bo
   if(!QFile::exists(vtkFile)) return;
 
 	reader = NULL;
- 	reader = vtkSmartPointer<vtkXMLImageDataReader>::New();
-  reader->SetFileName(vtkFile.toStdString().c_str());
-  reader->Update();
+ 	reader = openResult(vtkFile);
 
 	geometryFilter = NULL;
   geometryFilter =
@@ -309,9 +318,7 @@ void VisualizeDisplay::vector(QString vtkFile, int normal, double origin) {
   if(!QFile::exists(vtkFile)) return;
   
 	vectReader = NULL;
- 	vectReader = vtkSmartPointer<vtkXMLImageDataReader>::New();
-  vectReader->SetFileName(vtkFile.toStdString().c_str());
-  vectReader->Update();
+ 	vectReader = openResult(vtkFile);
 
   vectGeometryFilter =
     vtkSmartPointer<vtkGeometryFilter>::New();
@@ -366,7 +373,7 @@ void VisualizeDisplay::vector(QString vtkFile, int normal, double origin) {
   vectMapper->SetInputConnection(glyph->GetOutputPort());
   //VTKmapper->SetLookupTable(lut);
   vectMapper->ScalarVisibilityOn();
-  vectMapper->SetScalarRange(vectReader->GetOutput()->GetScalarRange());
+  vectMapper->SetScalarRange(vectReader->GetOutputAsDataSet()->GetScalarRange());
 
   vectActor->SetMapper(vectMapper);
 
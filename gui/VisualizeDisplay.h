@@ -11,6 +11,7 @@
 
 #include <vtkDataReader.h>
 #include <vtkXMLImageDataReader.h>
+#include <vtkXMLPImageDataReader.h>
 #include <vtkStructuredPoints.h>
 #include <vtkCutter.h>
 #include <vtkPolyDataMapper.h>
@@ -60,10 +61,12 @@ public:
   void clear();
 
 protected:
-  vtkSmartPointer<vtkXMLImageDataReader> reader;
+  static vtkSmartPointer<vtkXMLReader> openResult(QString vtkFile);
+
+  vtkSmartPointer<vtkXMLReader> reader;
   vtkSmartPointer<vtkPolyDataMapper> VTKmapper;
   vtkSmartPointer<vtkActor> VTKactor;
-  vtkSmartPointer<vtkXMLImageDataReader> vectReader;
+  vtkSmartPointer<vtkXMLReader> vectReader;
   vtkSmartPointer<vtkGeometryFilter> geometryFilter;
   vtkSmartPointer<vtkGeometryFilter> vectGeometryFilter;
   vtkSmartPointer<vtkPolyDataMapper> vectMapper;
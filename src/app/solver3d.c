@@ -45,15 +45,11 @@ int main(int argc, char *argv[])
   if (argc > 2) delt = atof(argv[2]);
   else delt = -1;
   
-  if(size > 1) {
-    ret = solver_mpi(solver, timestep, delt);
-    PetscEnd();
-    return ret;
-  }
-  else {
-    printf("error: Run must be invoked using mpirun/mpiexec with at least 2 processes\n");
-  }
+  /* a single process solves the whole mesh on its own, threaded per solver.xml */
+  if(size == 1) printf("running as a single process\n");
 
-
-  return(0);
+  ret = solver_mpi(solver, timestep, delt);
+  PetscEnd();
+  return ret;
 }
+
@@ -3,6 +3,7 @@
  * routines to read/write csv files */
 
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 #include <sys/stat.h>
 
@@ -36,9 +37,7 @@ int csv_read_U(struct mesh_data *mesh, double timestep)
 
   sprintf(filename, "%4.3lf/U.csv", timestep);
 
-  return csv_read_vector_grid(filename, 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->u, mesh->v, mesh->w);
+  return csv_read_vector_mesh(mesh, filename, mesh->u, mesh->v, mesh->w);
 
 }
 int csv_write_U(struct mesh_data *mesh, double timestep)
@@ -59,12 +58,7 @@ int csv_write_U(struct mesh_data *mesh, double timestep)
   
   sprintf(filename, "%4.3lf/U.csv", timestep);
 
-  if(mesh->compress) return csv_compressed_write_vector_grid(filename, "u, v, w", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->u, mesh->v, mesh->w);
-  else return csv_write_vector_grid(filename, "u, v, w", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->u, mesh->v, mesh->w);
+  return csv_write_vector_mesh(mesh, filename, "u, v, w", mesh->u, mesh->v, mesh->w);
 
 }
 int csv_write_vorticity(struct mesh_data *mesh, double timestep)
@@ -85,12 +79,8 @@ int csv_write_vorticity(struct mesh_data *mesh, double timestep)
   
   sprintf(filename, "%4.3lf/vorticity.csv", timestep);
 
-  if(mesh->compress)  csv_compressed_write_vector_grid(filename, "u-vorticity, v-vorticity, w-vorticity", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->u_omega, mesh->v_omega, mesh->w_omega);
-  else return csv_write_vector_grid(filename, "u-vorticity, v-vorticity, w-vorticity", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->u_omega, mesh->v_omega, mesh->w_omega);
+  return csv_write_vector_mesh(mesh, filename, "u-vorticity, v-vorticity, w-vorticity", 
+                               mesh->u_omega, mesh->v_omega, mesh->w_omega);
 
 }
 int csv_read_P(struct mesh_data *mesh, double timestep)
@@ -99,9 +89,7 @@ int csv_read_P(struct mesh_data *mesh, double timestep)
 
   sprintf(filename, "%4.3lf/P.csv", timestep);
 
-  return csv_read_scalar_grid(filename, 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->P);
+  return csv_read_scalar_mesh(mesh, filename, mesh->P);
 
 }
 int csv_write_P(struct mesh_data *mesh, double timestep)
@@ -122,12 +110,7 @@ int csv_write_P(struct mesh_data *mesh, double timestep)
 	
   sprintf(filename, "%4.3lf/P.csv", timestep);
 
-  if(mesh->compress) return csv_compressed_write_scalar_grid(filename, "P", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->P);
-  else return csv_write_scalar_grid(filename, "P", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->P);
+  return csv_write_scalar_mesh(mesh, filename, "P", mesh->P);
 
 }
 int csv_read_vof(struct mesh_data *mesh, double timestep)
@@ -136,9 +119,7 @@ int csv_read_vof(struct mesh_data *mesh, double timestep)
 
   sprintf(filename, "%4.3lf/vof.csv", timestep);
 
-  return csv_read_scalar_grid(filename, 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->vof);
+  return csv_read_scalar_mesh(mesh, filename, mesh->vof);
 
 }
 int csv_read_n_vof(struct mesh_data *mesh, double timestep)
@@ -147,9 +128,7 @@ int csv_read_n_vof(struct mesh_data *mesh, double timestep)
 
   sprintf(filename, "%4.3lf/n_vof.csv", timestep);
 
-  return csv_read_integer_grid(filename, 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->n_vof);
+  return csv_read_integer_mesh(mesh, filename, (int *) mesh->n_vof);
 
 }
 int csv_write_n_vof(struct mesh_data *mesh, double timestep)
@@ -170,12 +149,7 @@ int csv_write_n_vof(struct mesh_data *mesh, double timestep)
 	
   sprintf(filename, "%4.3lf/n_vof.csv", timestep);
 
-  if(mesh->compress) return csv_compressed_write_integer_grid(filename, "n_vof", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->n_vof);
-  else return csv_write_integer_grid(filename, "n_vof", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->n_vof);
+  return csv_write_integer_mesh(mesh, filename, "n_vof", (int *) mesh->n_vof);
 
 }
 int csv_write_vof(struct mesh_data *mesh, double timestep)
@@ -196,12 +170,7 @@ int csv_write_vof(struct mesh_data *mesh, double timestep)
 	
   sprintf(filename, "%4.3lf/vof.csv", timestep);
 
-  if(mesh->compress) return csv_compressed_write_scalar_grid(filename, "vof", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->vof);
-  else return csv_write_scalar_grid(filename, "vof", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->vof);
+  return csv_write_scalar_mesh(mesh, filename, "vof", mesh->vof);
 
 }
 int csv_read_af(struct mesh_data *mesh, double timestep)
@@ -210,9 +179,7 @@ int csv_read_af(struct mesh_data *mesh, double timestep)
 
   sprintf(filename, "%4.3lf/af.csv", timestep);
 
-  return csv_read_vector_grid(filename, 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->ae, mesh->an, mesh->at);
+  return csv_read_vector_mesh(mesh, filename, mesh->ae, mesh->an, mesh->at);
 
 }
 int csv_write_af(struct mesh_data *mesh, double timestep)
@@ -221,12 +188,7 @@ int csv_write_af(struct mesh_data *mesh, double timestep)
 
   sprintf(filename, "%4.3lf/af.csv", timestep);
 
-  if(mesh->compress)  return csv_compressed_write_vector_grid(filename, "ae, an, at", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->ae, mesh->an, mesh->at);
-  else return csv_write_vector_grid(filename, "ae, an, at", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->ae, mesh->an, mesh->at);
+  return csv_write_vector_mesh(mesh, filename, "ae, an, at", mesh->ae, mesh->an, mesh->at);
 
 }
 int csv_read_fv(struct mesh_data *mesh, double timestep)
@@ -235,9 +197,7 @@ int csv_read_fv(struct mesh_data *mesh, double timestep)
 
   sprintf(filename, "%4.3lf/fv.csv", timestep);
 
-  return csv_read_scalar_grid(filename, 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->fv);
+  return csv_read_scalar_mesh(mesh, filename, mesh->fv);
 
 }
 int csv_write_fv(struct mesh_data *mesh, double timestep)
@@ -246,12 +206,7 @@ int csv_write_fv(struct mesh_data *mesh, double timestep)
 
   sprintf(filename, "%4.3lf/fv.csv", timestep);
 
-  if(mesh->compress)  return csv_compressed_write_scalar_grid(filename, "fv", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->fv); 
-  else return csv_write_scalar_grid(filename, "fv", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        mesh->fv);
+  return csv_write_scalar_mesh(mesh, filename, "fv", mesh->fv);
 
 }
 int csv_read_k(struct mesh_data *mesh, double timestep)
@@ -263,9 +218,7 @@ int csv_read_k(struct mesh_data *mesh, double timestep)
 
   sprintf(filename, "%4.3lf/k.csv", timestep);
 
-  return csv_read_scalar_grid(filename, 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        turb->k);
+  return csv_read_scalar_mesh(mesh, filename, turb->k);
 
 }
 int csv_write_k(struct mesh_data *mesh, double timestep)
@@ -277,12 +230,7 @@ int csv_write_k(struct mesh_data *mesh, double timestep)
 
   sprintf(filename, "%4.3lf/k.csv", timestep);
 
-  if(mesh->compress)  return csv_compressed_write_scalar_grid(filename, "k", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        turb->k);
-  else return csv_write_scalar_grid(filename, "k", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        turb->k);
+  return csv_write_scalar_mesh(mesh, filename, "k", turb->k);
 
 }
 int csv_read_E(struct mesh_data *mesh, double timestep)
@@ -294,9 +242,7 @@ int csv_read_E(struct mesh_data *mesh, double timestep)
 
   sprintf(filename, "%4.3lf/E.csv", timestep);
 
-  return csv_read_scalar_grid(filename, 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        turb->E);
+  return csv_read_scalar_mesh(mesh, filename, turb->E);
 
 }
 int csv_write_E(struct mesh_data *mesh, double timestep)
@@ -308,16 +254,12 @@ int csv_write_E(struct mesh_data *mesh, double timestep)
 
   sprintf(filename, "%4.3lf/E.csv", timestep);
 
-  if(mesh->compress) return csv_compressed_write_scalar_grid(filename, "E", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        turb->E); 
-  else return csv_write_scalar_grid(filename, "E", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
-                        turb->E);
+  return csv_write_scalar_mesh(mesh, filename, "E", turb->E);
 
 }
-long int csv_read_scalar_grid(char *filename,  
+long int csv_read_scalar_slab(char *filename,  
                           long int ni, long int nj, long int nk,
+                          long int i_start, long int i_range,
                           double *scalars) {
   FILE *fp;
   long int i, j, k, count, n;
@@ -332,7 +274,7 @@ long int csv_read_scalar_grid(char *filename,
   fp = fopen(filename, "r");
 
   if(fp == NULL) {
-    n = csv_compressed_read_scalar_grid(filename, ni, nj, nk, scalars);
+    n = csv_compressed_read_scalar_slab(filename, ni, nj, nk, i_start, i_range, scalars);
     if(n == -1) {
       printf("error: csv_read_scalar_grid cannot open %s to read\n", filename);
       return -1;
@@ -359,7 +301,9 @@ long int csv_read_scalar_grid(char *filename,
       break;
     }
 
-    scalars[CELL_INDEX(i,j,k)] = f;
+    if(i < i_start || i >= i_start + i_range) continue;
+
+    scalars[CELL_INDEX(i - i_start,j,k)] = f;
     count++;
   }
 
@@ -367,8 +311,15 @@ long int csv_read_scalar_grid(char *filename,
 
   return count;
 }
-long int csv_read_integer_grid(char *filename,  
+
+long int csv_read_scalar_grid(char *filename,  
+                          long int ni, long int nj, long int nk,
+                          double *scalars) {
+  return csv_read_scalar_slab(filename, ni, nj, nk, 0, ni, scalars);
+}
+long int csv_read_integer_slab(char *filename,  
                           long int ni, long int nj, long int nk,
+                          long int i_start, long int i_range,
                           int *scalars) {
   FILE *fp;
   long int i, j, k, count, n;
@@ -383,7 +334,7 @@ long int csv_read_integer_grid(char *filename,
   fp = fopen(filename, "r");
 
   if(fp == NULL) {
-    n = csv_compressed_read_integer_grid(filename, ni, nj, nk, scalars);
+    n = csv_compressed_read_integer_slab(filename, ni, nj, nk, i_start, i_range, scalars);
     if(n == -1) {
       printf("error: csv_read_scalar_grid cannot open %s to read\n", filename);
       return -1;
@@ -410,7 +361,9 @@ long int csv_read_integer_grid(char *filename,
       break;
     }
 
-    scalars[CELL_INDEX(i,j,k)] = f;
+    if(i < i_start || i >= i_start + i_range) continue;
+
+    scalars[CELL_INDEX(i - i_start,j,k)] = f;
     count++;
   }
 
@@ -419,8 +372,15 @@ long int csv_read_integer_grid(char *filename,
   return count;
 }
 
-long int csv_read_vector_grid(char *filename,  
+long int csv_read_integer_grid(char *filename,  
+                          long int ni, long int nj, long int nk,
+                          int *scalars) {
+  return csv_read_integer_slab(filename, ni, nj, nk, 0, ni, scalars);
+}
+
+long int csv_read_vector_slab(char *filename,  
                           long int ni, long int nj, long int nk,
+                          long int i_start, long int i_range,
                           double *v0, double *v1, double *v2) {
   FILE *fp;
   long int i, j, k, count, n;
@@ -435,7 +395,7 @@ long int csv_read_vector_grid(char *filename,
   fp = fopen(filename, "r");
 
   if(fp == NULL) {
-    n = csv_compressed_read_vector_grid(filename, ni, nj, nk, v0, v1, v2);
+    n = csv_compressed_read_vector_slab(filename, ni, nj, nk, i_start, i_range, v0, v1, v2);
     if(n == -1) {
       printf("error: csv_read_vector_grid cannot open %s to read\n", filename);
       return -1;
@@ -462,9 +422,11 @@ long int csv_read_vector_grid(char *filename,
       break;
     }
 
-    v0[CELL_INDEX(i,j,k)] = f;
-    v1[CELL_INDEX(i,j,k)] = g;
-    v2[CELL_INDEX(i,j,k)] = h;
+    if(i < i_start || i >= i_start + i_range) continue;
+
+    v0[CELL_INDEX(i - i_start,j,k)] = f;
+    v1[CELL_INDEX(i - i_start,j,k)] = g;
+    v2[CELL_INDEX(i - i_start,j,k)] = h;
     count++;
   }
 
@@ -473,7 +435,14 @@ long int csv_read_vector_grid(char *filename,
   return count;
 }
 
-int csv_write_vector_grid(char *filename, char *dataset_name, long int ni, long int nj, long int nk,
+long int csv_read_vector_grid(char *filename,  
+                          long int ni, long int nj, long int nk,
+                          double *v0, double *v1, double *v2) {
+  return csv_read_vector_slab(filename, ni, nj, nk, 0, ni, v0, v1, v2);
+}
+
+int csv_write_vector_slab(char *filename, char *dataset_name, long int i_offset,
+                          long int ni, long int nj, long int nk,
                           double *v0, double *v1, double *v2) {
   FILE *fp;
   long int i, j, k;
@@ -501,7 +470,7 @@ int csv_write_vector_grid(char *filename, char *dataset_name, long int ni, long
         
         if(fabs(v0[CELL_INDEX(i,j,k)]) > emf || fabs(v1[CELL_INDEX(i,j,k)]) > emf ||  
            fabs(v2[CELL_INDEX(i,j,k)]) > emf )
-          fprintf(fp, "%ld, %ld, %ld, %lf, %lf, %lf\n", i, j, k, 
+          fprintf(fp, "%ld, %ld, %ld, %lf, %lf, %lf\n", i + i_offset, j, k, 
                 v0[CELL_INDEX(i,j,k)], v1[CELL_INDEX(i,j,k)], 
                 v2[CELL_INDEX(i,j,k)]); 
      
@@ -514,7 +483,13 @@ int csv_write_vector_grid(char *filename, char *dataset_name, long int ni, long
   return 0;
 }
 
-int csv_write_scalar_grid(char *filename, char *dataset_name, long int ni, long int nj, long int nk,
+int csv_write_vector_grid(char *filename, char *dataset_name, long int ni, long int nj, long int nk,
+                          double *v0, double *v1, double *v2) {
+  return csv_write_vector_slab(filename, dataset_name, 0, ni, nj, nk, v0, v1, v2);
+}
+
+int csv_write_scalar_slab(char *filename, char *dataset_name, long int i_offset,
+                          long int ni, long int nj, long int nk,
                           double *scalars) {
   FILE *fp;
   long int i, j, k;
@@ -541,7 +516,7 @@ int csv_write_scalar_grid(char *filename, char *dataset_name, long int ni, long
       for(k=0; k<nk; k++) {
         
         if(fabs(scalars[CELL_INDEX(i,j,k)]) > emf) 
-          fprintf(fp, "%ld, %ld, %ld, %10.8lf\n", i, j, k, 
+          fprintf(fp, "%ld, %ld, %ld, %10.8lf\n", i + i_offset, j, k, 
                 scalars[CELL_INDEX(i,j,k)]); 
       
       }
@@ -553,7 +528,13 @@ int csv_write_scalar_grid(char *filename, char *dataset_name, long int ni, long
   return 0;
 }
 
-int csv_write_integer_grid(char *filename, char *dataset_name, long int ni, long int nj, long int nk,
+int csv_write_scalar_grid(char *filename, char *dataset_name, long int ni, long int nj, long int nk,
+                          double *scalars) {
+  return csv_write_scalar_slab(filename, dataset_name, 0, ni, nj, nk, scalars);
+}
+
+int csv_write_integer_slab(char *filename, char *dataset_name, long int i_offset,
+                          long int ni, long int nj, long int nk,
                           int *scalars) {
   FILE *fp;
   long int i, j, k;
@@ -578,7 +559,7 @@ int csv_write_integer_grid(char *filename, char *dataset_name, long int ni, long
     for(j=0; j<nj; j++) {
       for(k=0; k<nk; k++) {
         
-          fprintf(fp, "%ld, %ld, %ld, %d\n", i, j, k, 
+          fprintf(fp, "%ld, %ld, %ld, %d\n", i + i_offset, j, k, 
                 scalars[CELL_INDEX(i,j,k)]); 
       
       }
@@ -590,6 +571,11 @@ int csv_write_integer_grid(char *filename, char *dataset_name, long int ni, long
   return 0;
 }
 
+int csv_write_integer_grid(char *filename, char *dataset_name, long int ni, long int nj, long int nk,
+                          int *scalars) {
+  return csv_write_integer_slab(filename, dataset_name, 0, ni, nj, nk, scalars);
+}
+
 int csv_write_scalar_grid_paraview(char *filename, char *dataset_name, 
                           long int ni, long int nj, long int nk,
                           double oi, double oj, double ok,
@@ -638,6 +624,223 @@ int csv_write_scalar_grid_paraview(char *filename, char *dataset_name,
   return 0;
 }
 
+/* name of piece n of a distributed field, P.csv becomes P_n.csv */
+static void csv_piece_filename(char *piece, char *filename, int n) {
+  char *ext;
+
+  strcpy(piece, filename);
+  ext = strrchr(piece, '.');
+  if(ext == NULL) ext = piece + strlen(piece);
+  sprintf(ext, "_%d%s", n, filename + (ext - piece));
+}
+
+/* whether a csv file exists, plain or gzipped */
+static int csv_exists(char *filename) {
+  char filename_gz[1024];
+  FILE *fp;
+
+  sprintf(filename_gz, "%s.gz", filename);
+  if((fp = fopen(filename, "r")) == NULL && (fp = fopen(filename_gz, "r")) == NULL)
+    return 0;
+  fclose(fp);
+
+  return 1;
+}
+
+/* names the piece this process writes.  piece 0 also clears the whole-mesh
+ * file and pieces left over from a run on more processes, since readers 
+ * prefer the former and take every piece they find */
+static void csv_piece_prepare(struct mesh_data *mesh, char *filename, char *piece) {
+  char stale[1024];
+  int n;
+
+  csv_piece_filename(piece, filename, mesh->piece);
+  if(mesh->piece != 0) return;
+
+  csv_remove(filename);
+  for(n = mesh->pieces; ; n++) {
+    csv_piece_filename(stale, filename, n);
+    if(!csv_exists(stale)) break;
+    csv_remove(stale);
+  }
+}
+
+/* the mesh level readers fill the slab held by this process, or the whole
+ * mesh.  they read the whole-mesh file if there is one, otherwise every piece 
+ * written by the previous run, whatever number of processes wrote them */
+long int csv_read_scalar_mesh(struct mesh_data *mesh, char *filename, double *scalars) {
+  char piece[1024];
+  long int count = 0, n_read, i_start, i_range;
+  int n;
+
+  i_start = 0;
+  i_range = mesh->imax;
+  if(mesh->piece >= 0) {
+    i_start = mesh->i_start;
+    i_range = mesh->i_range;
+  }
+
+  if(csv_exists(filename)) 
+    return csv_read_scalar_slab(filename, mesh->imax, mesh->jmax, mesh->kmax, 
+                                i_start, i_range, scalars);
+
+  for(n = 0; ; n++) {
+    csv_piece_filename(piece, filename, n);
+    if(!csv_exists(piece)) break;
+
+    n_read = csv_read_scalar_slab(piece, mesh->imax, mesh->jmax, mesh->kmax, 
+                                  i_start, i_range, scalars);
+    if(n_read == -1) return -1;
+    count += n_read;
+  }
+
+  if(n == 0) {
+    printf("error: csv_read_scalar_mesh cannot find %s or its pieces\n", filename);
+    return -1;
+  }
+
+  return count;
+}
+
+long int csv_read_integer_mesh(struct mesh_data *mesh, char *filename, int *scalars) {
+  char piece[1024];
+  long int count = 0, n_read, i_start, i_range;
+  int n;
+
+  i_start = 0;
+  i_range = mesh->imax;
+  if(mesh->piece >= 0) {
+    i_start = mesh->i_start;
+    i_range = mesh->i_range;
+  }
+
+  if(csv_exists(filename)) 
+    return csv_read_integer_slab(filename, mesh->imax, mesh->jmax, mesh->kmax, 
+                                 i_start, i_range, scalars);
+
+  for(n = 0; ; n++) {
+    csv_piece_filename(piece, filename, n);
+    if(!csv_exists(piece)) break;
+
+    n_read = csv_read_integer_slab(piece, mesh->imax, mesh->jmax, mesh->kmax, 
+                                   i_start, i_range, scalars);
+    if(n_read == -1) return -1;
+    count += n_read;
+  }
+
+  if(n == 0) {
+    printf("error: csv_read_integer_mesh cannot find %s or its pieces\n", filename);
+    return -1;
+  }
+
+  return count;
+}
+
+long int csv_read_vector_mesh(struct mesh_data *mesh, char *filename, 
+                              double *v0, double *v1, double *v2) {
+  char piece[1024];
+  long int count = 0, n_read, i_start, i_range;
+  int n;
+
+  i_start = 0;
+  i_range = mesh->imax;
+  if(mesh->piece >= 0) {
+    i_start = mesh->i_start;
+    i_range = mesh->i_range;
+  }
+
+  if(csv_exists(filename)) 
+    return csv_read_vector_slab(filename, mesh->imax, mesh->jmax, mesh->kmax, 
+                                i_start, i_range, v0, v1, v2);
+
+  for(n = 0; ; n++) {
+    csv_piece_filename(piece, filename, n);
+    if(!csv_exists(piece)) break;
+
+    n_read = csv_read_vector_slab(piece, mesh->imax, mesh->jmax, mesh->kmax, 
+                                  i_start, i_range, v0, v1, v2);
+    if(n_read == -1) return -1;
+    count += n_read;
+  }
+
+  if(n == 0) {
+    printf("error: csv_read_vector_mesh cannot find %s or its pieces\n", filename);
+    return -1;
+  }
+
+  return count;
+}
+
+/* the mesh level writers write the whole mesh, or for a distributed piece 
+ * only the planes it owns, with global i indices */
+int csv_write_scalar_mesh(struct mesh_data *mesh, char *filename, char *dataset_name, 
+                          double *scalars) {
+  char piece[1024];
+  long int first;
+
+  if(mesh->piece < 0) {
+    if(mesh->compress) return csv_compressed_write_scalar_grid(filename, dataset_name, 
+                          mesh->imax, mesh->jmax, mesh->kmax, scalars);
+    else return csv_write_scalar_grid(filename, dataset_name, 
+                          mesh->imax, mesh->jmax, mesh->kmax, scalars);
+  }
+
+  csv_piece_prepare(mesh, filename, piece);
+  first = mesh_piece_first(mesh);
+  scalars += first * mesh->jmax * mesh->kmax;
+
+  if(mesh->compress) return csv_compressed_write_scalar_slab(piece, dataset_name, mesh->i_start + first,
+                          mesh_piece_planes(mesh), mesh->jmax, mesh->kmax, scalars);
+  else return csv_write_scalar_slab(piece, dataset_name, mesh->i_start + first,
+                          mesh_piece_planes(mesh), mesh->jmax, mesh->kmax, scalars);
+}
+
+int csv_write_integer_mesh(struct mesh_data *mesh, char *filename, char *dataset_name, 
+                           int *scalars) {
+  char piece[1024];
+  long int first;
+
+  if(mesh->piece < 0) {
+    if(mesh->compress) return csv_compressed_write_integer_grid(filename, dataset_name, 
+                          mesh->imax, mesh->jmax, mesh->kmax, scalars);
+    else return csv_write_integer_grid(filename, dataset_name, 
+                          mesh->imax, mesh->jmax, mesh->kmax, scalars);
+  }
+
+  csv_piece_prepare(mesh, filename, piece);
+  first = mesh_piece_first(mesh);
+  scalars += first * mesh->jmax * mesh->kmax;
+
+  if(mesh->compress) return csv_compressed_write_integer_slab(piece, dataset_name, mesh->i_start + first,
+                          mesh_piece_planes(mesh), mesh->jmax, mesh->kmax, scalars);
+  else return csv_write_integer_slab(piece, dataset_name, mesh->i_start + first,
+                          mesh_piece_planes(mesh), mesh->jmax, mesh->kmax, scalars);
+}
+
+int csv_write_vector_mesh(struct mesh_data *mesh, char *filename, char *dataset_name, 
+                          double *v0, double *v1, double *v2) {
+  char piece[1024];
+  long int first, offset;
+
+  if(mesh->piece < 0) {
+    if(mesh->compress) return csv_compressed_write_vector_grid(filename, dataset_name, 
+                          mesh->imax, mesh->jmax, mesh->kmax, v0, v1, v2);
+    else return csv_write_vector_grid(filename, dataset_name, 
+                          mesh->imax, mesh->jmax, mesh->kmax, v0, v1, v2);
+  }
+
+  csv_piece_prepare(mesh, filename, piece);
+  first = mesh_piece_first(mesh);
+  offset = first * mesh->jmax * mesh->kmax;
+
+  if(mesh->compress) return csv_compressed_write_vector_slab(piece, dataset_name, mesh->i_start + first,
+                          mesh_piece_planes(mesh), mesh->jmax, mesh->kmax, 
+                          v0 + offset, v1 + offset, v2 + offset);
+  else return csv_write_vector_slab(piece, dataset_name, mesh->i_start + first,
+                          mesh_piece_planes(mesh), mesh->jmax, mesh->kmax, 
+                          v0 + offset, v1 + offset, v2 + offset);
+}
+
 void csv_remove(char *filename) {
   char filename_gz[1024];
   
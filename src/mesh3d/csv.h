@@ -63,6 +63,43 @@ long int csv_compressed_read_vector_grid(char *filename_csv,
 int csv_read_af(struct mesh_data *mesh, double timestep);
 int csv_write_af(struct mesh_data *mesh, double timestep);
 
+long int csv_read_scalar_slab(char *filename, long int ni, long int nj, long int nk,
+                          long int i_start, long int i_range, double *scalars);
+long int csv_compressed_read_scalar_slab(char *filename_csv, long int ni, long int nj, long int nk,
+                          long int i_start, long int i_range, double *scalars);
+long int csv_read_integer_slab(char *filename, long int ni, long int nj, long int nk,
+                          long int i_start, long int i_range, int *scalars);
+long int csv_compressed_read_integer_slab(char *filename_csv, long int ni, long int nj, long int nk,
+                          long int i_start, long int i_range, int *scalars);
+long int csv_read_vector_slab(char *filename, long int ni, long int nj, long int nk,
+                          long int i_start, long int i_range, double *v0, double *v1, double *v2);
+long int csv_compressed_read_vector_slab(char *filename_csv, long int ni, long int nj, long int nk,
+                          long int i_start, long int i_range, double *v0, double *v1, double *v2);
+
+int csv_write_scalar_slab(char *filename, char *dataset_name, long int i_offset,
+                          long int ni, long int nj, long int nk, double *scalars);
+int csv_compressed_write_scalar_slab(char *filename_csv, char *dataset_name, long int i_offset,
+                          long int ni, long int nj, long int nk, double *scalars);
+int csv_write_integer_slab(char *filename, char *dataset_name, long int i_offset,
+                          long int ni, long int nj, long int nk, int *scalars);
+int csv_compressed_write_integer_slab(char *filename_csv, char *dataset_name, long int i_offset,
+                          long int ni, long int nj, long int nk, int *scalars);
+int csv_write_vector_slab(char *filename, char *dataset_name, long int i_offset,
+                          long int ni, long int nj, long int nk, double *v0, double *v1, double *v2);
+int csv_compressed_write_vector_slab(char *filename_csv, char *dataset_name, long int i_offset,
+                          long int ni, long int nj, long int nk, double *v0, double *v1, double *v2);
+
+long int csv_read_scalar_mesh(struct mesh_data *mesh, char *filename, double *scalars);
+long int csv_read_integer_mesh(struct mesh_data *mesh, char *filename, int *scalars);
+long int csv_read_vector_mesh(struct mesh_data *mesh, char *filename, 
+                          double *v0, double *v1, double *v2);
+int csv_write_scalar_mesh(struct mesh_data *mesh, char *filename, char *dataset_name, 
+                          double *scalars);
+int csv_write_integer_mesh(struct mesh_data *mesh, char *filename, char *dataset_name, 
+                          int *scalars);
+int csv_write_vector_mesh(struct mesh_data *mesh, char *filename, char *dataset_name, 
+                          double *v0, double *v1, double *v2);
+
 int csv_write_scalar_grid_paraview(char *filename, char *dataset_name, 
                           long int ni, long int nj, long int nk,
                           double oi, double oj, double ok,
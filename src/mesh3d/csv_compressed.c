@@ -17,7 +17,8 @@
  
 #define CELL_INDEX(i,j,k) ((k) + nk * ((j) + (i) * nj))
 
-int csv_compressed_write_scalar_grid(char *filename_csv, char *dataset_name, long int ni, long int nj, long int nk,
+int csv_compressed_write_scalar_slab(char *filename_csv, char *dataset_name, long int i_offset,
+                          long int ni, long int nj, long int nk,
                           double *scalars) {
   gzFile *fp;
   long int i, j, k;
@@ -48,7 +49,7 @@ int csv_compressed_write_scalar_grid(char *filename_csv, char *dataset_name, lon
       for(k=0; k<nk; k++) {
         
         if(fabs(scalars[CELL_INDEX(i,j,k)]) > emf) 
-          gzprintf(fp, "%ld, %ld, %ld, %10.8lf\n", i, j, k, 
+          gzprintf(fp, "%ld, %ld, %ld, %10.8lf\n", i + i_offset, j, k, 
                 scalars[CELL_INDEX(i,j,k)]); 
       
       }
@@ -60,7 +61,13 @@ int csv_compressed_write_scalar_grid(char *filename_csv, char *dataset_name, lon
   return 0;
 }
 
-int csv_compressed_write_vector_grid(char *filename_csv, char *dataset_name, long int ni, long int nj, long int nk,
+int csv_compressed_write_scalar_grid(char *filename_csv, char *dataset_name, long int ni, long int nj, long int nk,
+                          double *scalars) {
+  return csv_compressed_write_scalar_slab(filename_csv, dataset_name, 0, ni, nj, nk, scalars);
+}
+
+int csv_compressed_write_vector_slab(char *filename_csv, char *dataset_name, long int i_offset,
+                          long int ni, long int nj, long int nk,
                           double *v0, double *v1, double *v2) {
   gzFile *fp;
   long int i, j, k;
@@ -91,7 +98,7 @@ int csv_compressed_write_vector_grid(char *filename_csv, char *dataset_name, lon
         
         if(fabs(v0[CELL_INDEX(i,j,k)]) > emf || fabs(v1[CELL_INDEX(i,j,k)]) > emf ||  
            fabs(v2[CELL_INDEX(i,j,k)]) > emf )
-          gzprintf(fp, "%ld, %ld, %ld, %lf, %lf, %lf\n", i, j, k, 
+          gzprintf(fp, "%ld, %ld, %ld, %lf, %lf, %lf\n", i + i_offset, j, k, 
                 v0[CELL_INDEX(i,j,k)], v1[CELL_INDEX(i,j,k)], 
                 v2[CELL_INDEX(i,j,k)]); 
      
@@ -104,7 +111,13 @@ int csv_compressed_write_vector_grid(char *filename_csv, char *dataset_name, lon
   return 0;
 }
 
-int csv_compressed_write_integer_grid(char *filename_csv, char *dataset_name, long int ni, long int nj, long int nk,
+int csv_compressed_write_vector_grid(char *filename_csv, char *dataset_name, long int ni, long int nj, long int nk,
+                          double *v0, double *v1, double *v2) {
+  return csv_compressed_write_vector_slab(filename_csv, dataset_name, 0, ni, nj, nk, v0, v1, v2);
+}
+
+int csv_compressed_write_integer_slab(char *filename_csv, char *dataset_name, long int i_offset,
+                          long int ni, long int nj, long int nk,
                           int *scalars) {
   gzFile *fp;
   long int i, j, k;
@@ -132,7 +145,7 @@ int csv_compressed_write_integer_grid(char *filename_csv, char *dataset_name, lo
     for(j=0; j<nj; j++) {
       for(k=0; k<nk; k++) {
         
-          gzprintf(fp, "%ld, %ld, %ld, %d\n", i, j, k, 
+          gzprintf(fp, "%ld, %ld, %ld, %d\n", i + i_offset, j, k, 
                 scalars[CELL_INDEX(i,j,k)]); 
       
       }
@@ -144,8 +157,14 @@ int csv_compressed_write_integer_grid(char *filename_csv, char *dataset_name, lo
   return 0;
 }
 
-long int csv_compressed_read_scalar_grid(char *filename_csv,  
+int csv_compressed_write_integer_grid(char *filename_csv, char *dataset_name, long int ni, long int nj, long int nk,
+                          int *scalars) {
+  return csv_compressed_write_integer_slab(filename_csv, dataset_name, 0, ni, nj, nk, scalars);
+}
+
+long int csv_compressed_read_scalar_slab(char *filename_csv,  
                           long int ni, long int nj, long int nk,
+                          long int i_start, long int i_range,
                           double *scalars) {
   gzFile *fp;
   long int i, j, k, count;
@@ -194,7 +213,9 @@ long int csv_compressed_read_scalar_grid(char *filename_csv,
       break;
     }
 
-    scalars[CELL_INDEX(i,j,k)] = f;
+    if(i < i_start || i >= i_start + i_range) continue;
+
+    scalars[CELL_INDEX(i - i_start,j,k)] = f;
     count++;
   }
 
@@ -203,8 +224,15 @@ long int csv_compressed_read_scalar_grid(char *filename_csv,
   return count;
 }
 
-long int csv_compressed_read_integer_grid(char *filename_csv,  
+long int csv_compressed_read_scalar_grid(char *filename_csv,  
+                          long int ni, long int nj, long int nk,
+                          double *scalars) {
+  return csv_compressed_read_scalar_slab(filename_csv, ni, nj, nk, 0, ni, scalars);
+}
+
+long int csv_compressed_read_integer_slab(char *filename_csv,  
                           long int ni, long int nj, long int nk,
+                          long int i_start, long int i_range,
                           int *scalars) {
   FILE *fp;
   long int i, j, k, count;
@@ -253,7 +281,9 @@ long int csv_compressed_read_integer_grid(char *filename_csv,
       break;
     }
 
-    scalars[CELL_INDEX(i,j,k)] = f;
+    if(i < i_start || i >= i_start + i_range) continue;
+
+    scalars[CELL_INDEX(i - i_start,j,k)] = f;
     count++;
   }
 
@@ -262,8 +292,15 @@ long int csv_compressed_read_integer_grid(char *filename_csv,
   return count;
 }
 
-long int csv_compressed_read_vector_grid(char *filename_csv,  
+long int csv_compressed_read_integer_grid(char *filename_csv,  
                           long int ni, long int nj, long int nk,
+                          int *scalars) {
+  return csv_compressed_read_integer_slab(filename_csv, ni, nj, nk, 0, ni, scalars);
+}
+
+long int csv_compressed_read_vector_slab(char *filename_csv,  
+                          long int ni, long int nj, long int nk,
+                          long int i_start, long int i_range,
                           double *v0, double *v1, double *v2) {
   gzFile *fp;
   long int i, j, k, count;
@@ -312,9 +349,11 @@ long int csv_compressed_read_vector_grid(char *filename_csv,
       break;
     }
 
-    v0[CELL_INDEX(i,j,k)] = f;
-    v1[CELL_INDEX(i,j,k)] = g;
-    v2[CELL_INDEX(i,j,k)] = h;
+    if(i < i_start || i >= i_start + i_range) continue;
+
+    v0[CELL_INDEX(i - i_start,j,k)] = f;
+    v1[CELL_INDEX(i - i_start,j,k)] = g;
+    v2[CELL_INDEX(i - i_start,j,k)] = h;
     count++;
   }
 
@@ -322,3 +361,9 @@ long int csv_compressed_read_vector_grid(char *filename_csv,
 
   return count;
 }
+
+long int csv_compressed_read_vector_grid(char *filename_csv,  
+                          long int ni, long int nj, long int nk,
+                          double *v0, double *v1, double *v2) {
+  return csv_compressed_read_vector_slab(filename_csv, ni, nj, nk, 0, ni, v0, v1, v2);
+}
@@ -137,6 +137,8 @@ struct mesh_data *mesh_init_empty() {
   mesh->inside[2] = 0.1;
   
   mesh->compress = 1;
+  mesh->piece = -1;
+  mesh->pieces = 1;
 
   for(i = 0; i < 6; i++) {
     mesh->wb[i] = slip;
@@ -172,12 +174,15 @@ struct mesh_data *mesh_init_empty() {
 #define min(a,b) (a<b?a:b)
 
 int mesh_set_hydrostatic(struct mesh_data *mesh, double g, double rho) {
-  long int i,j,k;
+  long int i,j,k,imax;
 
 
   mesh_set_array(mesh, "P", 0, -1, 0, 0, 0, 0, 0);
 
-  for(i = 0; i < mesh->imax; i++) {
+  if(mesh->piece >= 0) imax = mesh->i_range;
+  else imax = mesh->imax;
+
+  for(i = 0; i < imax; i++) {
     for(j = 0; j < mesh->jmax; j++) {
       for(k = mesh->kmax-2; k > -1; k--) {
         if(mesh->vof[mesh_index(mesh,i,j,k)] == 1.0) {
@@ -215,6 +220,12 @@ int mesh_set_array(struct mesh_data *mesh, char *param, double value,
   if(jmax > mesh->jmax) jmax = mesh->jmax;
   if(kmax > mesh->kmax) kmax = mesh->kmax;
 
+  /* a distributed piece only stores its own slab of the i range */
+  if(mesh->piece >= 0) {
+    imin = max(imin - mesh->i_start, 0);
+    imax = min(imax - mesh->i_start, mesh->i_range);
+  }
+
   if(strcmp(param, "vof") == 0) p = mesh->vof;
   else if(strcmp(param, "P") == 0) p = mesh->P;
   else if(strcmp(param, "u") == 0) p = mesh->u;
@@ -808,8 +819,15 @@ inline long int mesh_index(struct mesh_data *mesh,
 
 int mesh_fill_vof(struct mesh_data *mesh, double *vector) {
   /* fill the mesh from the inside vector point until either a VOF > 0 or FV < 1 is encountered */
+  /* a distributed piece fills only within its own slab, stack points stay global */
 
   struct point_data *stack = NULL, *p;
+  long int i_start = 0, i_end = mesh->imax, l;
+
+  if(mesh->piece >= 0) {
+    i_start = mesh->i_start;
+    i_end = mesh->i_start + mesh->i_range;
+  }
 
   /* Modified to be relative to origin 07/27/2018 */
   stack = stack_push(stack, (vector[0]-mesh->origin[0])/mesh->delx, (vector[1]-mesh->origin[1])/mesh->dely, 
@@ -817,17 +835,18 @@ int mesh_fill_vof(struct mesh_data *mesh, double *vector) {
 
   while((p = stack_pop(stack)) != NULL) {
     
-    if(p->i >= mesh->imax || p->j >= mesh->jmax || p->k >= mesh->kmax || 
-       p->i < 0           || p->j < 0           || p->k < 0 ) {
+    if(p->i >= i_end      || p->j >= mesh->jmax || p->k >= mesh->kmax || 
+       p->i < i_start     || p->j < 0           || p->k < 0 ) {
       free(p);
       continue;
     }
+    l = p->i - i_start;
 
-    if(mesh->fv[mesh_index(mesh, p->i, p->j, p->k)]  > 0.0 && 
-       mesh->vof[mesh_index(mesh, p->i, p->j, p->k)] < 1.0) {
+    if(mesh->fv[mesh_index(mesh, l, p->j, p->k)]  > 0.0 && 
+       mesh->vof[mesh_index(mesh, l, p->j, p->k)] < 1.0) {
     
 
-      mesh->vof[mesh_index(mesh, p->i, p->j, p->k)] = 1.0;
+      mesh->vof[mesh_index(mesh, l, p->j, p->k)] = 1.0;
       
       stack = stack_push(stack, p->i + 1, p->j, p->k);
       stack = stack_push(stack, p->i - 1, p->j, p->k);
@@ -9,6 +9,52 @@
 #include "mesh_data.h"
 #include "stl.h"
 
+#ifdef _WIN32
+#define MESH_INLINE static __inline
+#else
+#define MESH_INLINE static inline
+#endif
+
+/* header version of mesh_index so the offset calc can be inlined into the solver loops */
+MESH_INLINE long int mesh_offset(const struct mesh_data *mesh,
+                                 long int i, long int j, long int k) {
+  return k + mesh->kmax * (j + i * mesh->jmax);
+}
+
+/* view of a cell array with precomputed strides.  compute the offset of (i,j,k) 
+ * once with MESH_VIEW_OFFSET and reach the neighbours with +/- si, sj or 1 */
+struct mesh_view {
+  double *base;
+  long int si; /* jmax * kmax */
+  long int sj; /* kmax */
+};
+
+MESH_INLINE struct mesh_view mesh_view(const struct mesh_data *mesh, double *base) {
+  struct mesh_view view;
+
+  view.base = base;
+  view.sj = mesh->kmax;
+  view.si = mesh->kmax * mesh->jmax;
+
+  return view;
+}
+
+#define MESH_VIEW_OFFSET(view, i, j, k) ((k) + (view).sj * (j) + (view).si * (i))
+
+/* first local plane of a distributed piece, skipping the halo plane
+ * shared with the upstream neighbour */
+MESH_INLINE long int mesh_piece_first(const struct mesh_data *mesh) {
+  return mesh->i_start > 0 ? 1 : 0;
+}
+
+/* number of planes owned by a distributed piece, without halo planes */
+MESH_INLINE long int mesh_piece_planes(const struct mesh_data *mesh) {
+  long int planes = mesh->i_range - mesh_piece_first(mesh);
+
+  if(mesh->i_start + mesh->i_range < mesh->imax) planes--;
+  return planes;
+}
+
 #ifndef _VOF_MACROS_H
 #define FV(i, j, k) mesh->fv[mesh_index(mesh, i, j, k)]
 #define AE(i, j, k) mesh->ae[mesh_index(mesh, i, j, k)]
@@ -113,6 +113,10 @@ struct mesh_data {
   
   /* flag to indicate whether output should be compressed */
   int compress;
+
+  /* piece of the mesh held by this process in a distributed run and
+   * the number of pieces.  piece -1 means the whole mesh is held here */
+  int piece, pieces;
   
   /* The next set of data describes 1D arrays of data that describe
    * the fluid properties.  The 1D arrays describe flattened
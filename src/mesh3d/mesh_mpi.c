@@ -21,7 +21,8 @@ long int mesh_mpi_space(struct mesh_data *mesh) {
   MPI_Comm_rank(MPI_COMM_WORLD, &rank);
   MPI_Comm_size(MPI_COMM_WORLD, &size);
 
-  if(!rank) space = (mesh->imax + size) * mesh->jmax * mesh->kmax; /* pads end of alloc for even gathers */
+  if(mesh->piece >= 0) space = mesh->i_range * mesh->jmax * mesh->kmax; /* no gathers, only the slab */
+  else if(!rank) space = (mesh->imax + size) * mesh->jmax * mesh->kmax; /* pads end of alloc for even gathers */
   else if(rank < size - 1) space = mesh->i_range * mesh->jmax * mesh->kmax;
   else space = (mesh->i_range + size) * mesh->jmax * mesh->kmax;
 
@@ -100,6 +101,8 @@ struct mesh_data *mesh_mpi_init_copy(struct mesh_data *mesh_source) {
 
   mesh->i_range = mesh_source->i_range;
   mesh->i_start = mesh_source->i_start;
+  mesh->piece = mesh_source->piece;
+  mesh->pieces = mesh_source->pieces;
 
   mesh->delx = mesh_source->delx;
   mesh->dely = mesh_source->dely;
@@ -14,16 +14,70 @@
 
 #define CELL_INDEX(i,j,k) ((k) + nk * ((j) + (i) * nj))
 
+/* names the output file and returns the offset of the first plane to write.
+ * a piece writes only its own planes, to vtk/<name>_<step>_<piece>.vti, 
+ * placed in the whole mesh by i0.  neighbouring scalar pieces share a point
+ * plane, vectors sit between cells and so take one from the halo */
+static long int vtk_piece(struct mesh_data *mesh, char *filename, char *name, int timestep,
+                          int vector, long int *i0, long int *ni) {
+  long int first;
+
+  if(mesh->piece < 0) {
+    sprintf(filename, "vtk/%s_%d.vti", name, timestep);
+    *i0 = 0;
+    *ni = mesh->imax;
+    return 0;
+  }
+
+  sprintf(filename, "vtk/%s_%d_%d.vti", name, timestep, mesh->piece);
+
+  first = vector ? 0 : mesh_piece_first(mesh);
+  *i0 = mesh->i_start + first;
+  *ni = mesh->i_range - first;
+  return first * mesh->jmax * mesh->kmax;
+}
+
+/* the .pvti master tying together the pieces of every process. 
+ * i_start and i_range hold the slab of each piece, single is as the
+ * pieces were written */
+int vtk_write_pvti(struct mesh_data *mesh, char *name, int timestep, int vector, int single,
+                   long int *i_start, long int *i_range) {
+  char filename[256], prefix[256];
+  long int i0[mesh->pieces], i1[mesh->pieces];
+  int n;
+
+  for(n = 0; n < mesh->pieces; n++) {
+    if(vector) {
+      i0[n] = i_start[n];
+      i1[n] = i_start[n] + i_range[n] - 2;
+    }
+    else {
+      i0[n] = i_start[n] + (i_start[n] > 0 ? 1 : 0);
+      i1[n] = i_start[n] + i_range[n] - 1;
+    }
+  }
+
+  sprintf(filename, "vtk/%s_%d.pvti", name, timestep);
+  sprintf(prefix, "%s_%d", name, timestep);
+
+  return vtk_xml_write_pvti(filename, name, prefix, vector, single,
+                        mesh->imax, mesh->jmax, mesh->kmax,
+                        mesh->origin[0], mesh->origin[1], mesh->origin[2],
+                        mesh->delx, mesh->dely, mesh->delz,
+                        mesh->pieces, i0, i1);
+}
+
 int vtk_write_fv(struct mesh_data *mesh, int timestep)
 {
   char filename[256];
+  long int i0, ni, offset;
 
-  sprintf(filename, "vtk/fv_%d.vti", timestep);
+  offset = vtk_piece(mesh, filename, "fv", timestep, 0, &i0, &ni);
 
-  return vtk_xml_write_scalar_grid(filename, "fv", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
+  return vtk_xml_write_scalar_piece(filename, "fv", 0,
+                        i0, ni, mesh->imax, mesh->jmax, mesh->kmax,
                         mesh->origin[0], mesh->origin[1], mesh->origin[2],
-                        mesh->delx, mesh->dely, mesh->delz, mesh->fv);
+                        mesh->delx, mesh->dely, mesh->delz, mesh->fv + offset);
 
 }
 /*
@@ -47,86 +101,92 @@ int vtk_write_n_vof(struct mesh_data *mesh, int timestep)
 int vtk_write_U(struct mesh_data *mesh, int timestep)
 {
   char filename[256];
-  
-  sprintf(filename, "vtk/U_%d.vti", timestep);
+  long int i0, ni, offset;
 
-  return vtk_xml_write_vector_grid(filename, "U", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
+  offset = vtk_piece(mesh, filename, "U", timestep, 1, &i0, &ni);
+
+  return vtk_xml_write_vector_piece(filename, "U", 1,
+                        i0, ni, mesh->imax, mesh->jmax, mesh->kmax,
                         mesh->origin[0], mesh->origin[1], mesh->origin[2],
                         mesh->delx, mesh->dely, mesh->delz, 
-                        mesh->u, mesh->v, mesh->w);
+                        mesh->u + offset, mesh->v + offset, mesh->w + offset);
 
 }
 
 int vtk_write_P(struct mesh_data *mesh, int timestep)
 {
   char filename[256];
+  long int i0, ni, offset;
 
-  sprintf(filename, "vtk/P_%d.vti", timestep);
+  offset = vtk_piece(mesh, filename, "P", timestep, 0, &i0, &ni);
 
-  return vtk_xml_write_scalar_grid(filename, "P", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
+  return vtk_xml_write_scalar_piece(filename, "P", 1,
+                        i0, ni, mesh->imax, mesh->jmax, mesh->kmax,
                         mesh->origin[0], mesh->origin[1], mesh->origin[2],
-                        mesh->delx, mesh->dely, mesh->delz, mesh->P);
+                        mesh->delx, mesh->dely, mesh->delz, mesh->P + offset);
 
 }
 
 int vtk_write_vorticity(struct mesh_data *mesh, int timestep)
 {
   char filename[256];
-  
- sprintf(filename, "vtk/vorticity_%d.vti", timestep);
- 
- return vtk_xml_write_vector_grid(filename, "vorticity", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
+  long int i0, ni, offset;
+
+  offset = vtk_piece(mesh, filename, "vorticity", timestep, 1, &i0, &ni);
+
+  return vtk_xml_write_vector_piece(filename, "vorticity", 1,
+                        i0, ni, mesh->imax, mesh->jmax, mesh->kmax,
                         mesh->origin[0], mesh->origin[1], mesh->origin[2],
                         mesh->delx, mesh->dely, mesh->delz, 
-                        mesh->u_omega, mesh->v_omega, mesh->w_omega);
+                        mesh->u_omega + offset, mesh->v_omega + offset, mesh->w_omega + offset);
 
 }
 
 int vtk_write_vof(struct mesh_data *mesh, int timestep)
 {
   char filename[256];
+  long int i0, ni, offset;
 
-  sprintf(filename, "vtk/vof_%d.vti", timestep);
+  offset = vtk_piece(mesh, filename, "vof", timestep, 0, &i0, &ni);
 
-  return vtk_xml_write_scalar_grid(filename, "vof", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
+  return vtk_xml_write_scalar_piece(filename, "vof", 0,
+                        i0, ni, mesh->imax, mesh->jmax, mesh->kmax,
                         mesh->origin[0], mesh->origin[1], mesh->origin[2],
-                        mesh->delx, mesh->dely, mesh->delz, mesh->vof);
+                        mesh->delx, mesh->dely, mesh->delz, mesh->vof + offset);
 
 }
 
 int vtk_write_k(struct mesh_data *mesh, int timestep)
 {
   char filename[256];
+  long int i0, ni, offset;
   struct kE_data *turb;
   
   turb = mesh->turbulence_model;
 
-  sprintf(filename, "vtk/k_%d.vti", timestep);
+  offset = vtk_piece(mesh, filename, "k", timestep, 0, &i0, &ni);
 
-  return vtk_xml_write_scalar_grid(filename, "k", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
+  return vtk_xml_write_scalar_piece(filename, "k", 1,
+                        i0, ni, mesh->imax, mesh->jmax, mesh->kmax,
                         mesh->origin[0], mesh->origin[1], mesh->origin[2],
-                        mesh->delx, mesh->dely, mesh->delz, turb->k);
+                        mesh->delx, mesh->dely, mesh->delz, turb->k + offset);
 
 }
 
 int vtk_write_E(struct mesh_data *mesh, int timestep)
 {
   char filename[256];
+  long int i0, ni, offset;
   struct kE_data *turb;
   
   turb = mesh->turbulence_model;
 
-  sprintf(filename, "vtk/E_%d.vti", timestep);
+  offset = vtk_piece(mesh, filename, "E", timestep, 0, &i0, &ni);
 
-  return vtk_xml_write_scalar_grid(filename, "E", 
-                        mesh->imax, mesh->jmax, mesh->kmax,
+  return vtk_xml_write_scalar_piece(filename, "E", 1,
+                        i0, ni, mesh->imax, mesh->jmax, mesh->kmax,
                         mesh->origin[0], mesh->origin[1], mesh->origin[2],
-                        mesh->delx, mesh->dely, mesh->delz, turb->E);
+                        mesh->delx, mesh->dely, mesh->delz, turb->E + offset);
 
 }
 
@@ -14,6 +14,8 @@ int vtk_write_vof(struct mesh_data *mesh, int timestep);
 int vtk_write_P(struct mesh_data *mesh, int timestep);
 int vtk_write_U(struct mesh_data *mesh, int timestep);
 int vtk_write_vorticity(struct mesh_data *mesh, int timestep);
+int vtk_write_pvti(struct mesh_data *mesh, char *name, int timestep, int vector, int single,
+                   long int *i_start, long int *i_range);
 int vtk_write_vector_grid(char *filename, char *dataset_name, 
                           long int ni, long int nj, long int nk,
                           double oi, double oj, double ok,
@@ -15,78 +15,299 @@
 
 #define CELL_INDEX(i,j,k) ((k) + nk * ((j) + (i) * nj))
 
+/* appended data is deflated in blocks of this many bytes, a whole number
+ * of vectors, so that threads can compress blocks independently */
+#define VTK_XML_BLOCK (3 * 8 * 32768)
+
+static int vtk_xml_level = Z_DEFAULT_COMPRESSION; /* 0 writes the data uncompressed */
+static int vtk_xml_raw = 0;     /* raw binary appended data instead of base64 */
+static int vtk_xml_float32 = 0; /* fields written as single are Float32 */
+static int vtk_xml_threads = 1;
+
+/* source of the values written to the appended data.  ni, nj and nk are
+ * the dimensions of the arrays in v */
+struct vtk_xml_field {
+  long int ni, nj, nk;
+  double *v[3];
+};
+
 unsigned char * base64_encode(const unsigned char *src, size_t len,
 			      size_t *out_len);
 
-int vtk_xml_write_scalar_grid(char *filename, char *dataset_name, 
-                          long int ni, long int nj, long int nk,
-                          double oi, double oj, double ok,
-                          double di, double dj, double dk,
-                          double *scalars) {
+/* format of the appended data: the zlib level, 0 for none, raw binary or
+ * base64, whether fields written as single drop to Float32, and the number
+ * of threads that compress the blocks */
+void vtk_xml_set_format(int level, int raw, int float32, int threads) {
+  vtk_xml_level = level;
+  vtk_xml_raw = raw;
+  vtk_xml_float32 = float32;
+  vtk_xml_threads = (threads < 1) ? 1 : threads;
+}
+
+static const char *vtk_xml_type(int single) {
+  return (single && vtk_xml_float32) ? "Float32" : "Float64";
+}
+
+/* opens filename and writes the VTKFile element for the current format */
+static FILE *vtk_xml_open(char *filename, char *type) {
   FILE *fp;
+
+  vtk_xml_remove(filename);
+
+  fp = fopen(filename, "wb");
+  if(fp == NULL) return NULL;
+
+  fprintf(fp, "<?xml version=\"1.0\"?>\n");
+  fprintf(fp, "<VTKFile type=\"%s\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt32\"%s > \n",
+              type, vtk_xml_level ? " compressor=\"vtkZLibDataCompressor\"" : "");
+
+  return fp;
+}
+
+/* converts n doubles to floats in place.  float n lies at or before
+ * double n, which has already been read */
+static void vtk_xml_narrow(double *in, long int n) {
+  float *out = (float *) in;
+  long int m;
+
+  for(m = 0; m < n; m++)
+    out[m] = in[m];
+}
+
+static void vtk_xml_encode(FILE *fp, const unsigned char *src, size_t len) {
+  unsigned char *enc;
+  size_t out_len;
+
+  if(vtk_xml_raw) {
+    fwrite(src, 1, len, fp);
+    return;
+  }
+
+  enc = base64_encode(src, len, &out_len);
+  fwrite(enc, 1, out_len, fp);
+  free(enc);
+}
+
+/* values first to first+count-1 of a scalar field in vtk order, i fastest */
+static void vtk_xml_fill_scalar(struct vtk_xml_field *field, long int first, long int count,
+                                double *dest) {
   long int i, j, k, n;
-  size_t len, out_len;
-  char *enc;
-  uint8_t arr[24];
-  long int count;
-  double dd[3];
-
-
-  int ret, flush;
-  unsigned have;
-  z_stream strm;
-  double *scalars_reorder;
-  unsigned char *in;
-  unsigned char *out;
+  long int ni = field->ni, nj = field->nj, nk = field->nk;
+
+  i = first % ni;
+  j = (first / ni) % nj;
+  k = first / (ni * nj);
+  for(n = 0; n < count; n++) {
+    dest[n] = field->v[0][CELL_INDEX(i,j,k)];
+    if(++i == ni) {
+      i = 0;
+      if(++j == nj) {
+        j = 0;
+        k++;
+      }
+    }
+  }
+}
 
-  uint32_t header[4];
-  unsigned char header_char[16];
+/* the same for a vector field, averaged onto the points between cells.
+ * first and count are whole vectors of three values */
+static void vtk_xml_fill_vector(struct vtk_xml_field *field, long int first, long int count,
+                                double *dest) {
+  const double emf = 0.000001;
+  long int i, j, k, n;
+  long int ni = field->ni, nj = field->nj, nk = field->nk;
+  double *v1 = field->v[0], *v2 = field->v[1], *v3 = field->v[2];
+
+  first /= 3;
+  i = first % (ni-1);
+  j = (first / (ni-1)) % (nj-1);
+  k = first / ((ni-1) * (nj-1));
+  for(n = 0; n < count; n += 3) {
+    if( (fabs(v1[CELL_INDEX(i,j,k)]) > emf && fabs(v1[CELL_INDEX(i+1,j,k)]) > emf) || 
+        (fabs(v2[CELL_INDEX(i,j,k)]) > emf && fabs(v2[CELL_INDEX(i,j+1,k)]) > emf) ||  
+        (fabs(v3[CELL_INDEX(i,j,k)]) > emf && fabs(v3[CELL_INDEX(i,j,k+1)]) > emf) ) {
+
+      dest[n]   = (v1[CELL_INDEX(i,j,k)] + v1[CELL_INDEX(i+1,j,k)])/2;
+      dest[n+1] = (v2[CELL_INDEX(i,j,k)] + v2[CELL_INDEX(i,j+1,k)])/2;
+      dest[n+2] = (v3[CELL_INDEX(i,j,k)] + v3[CELL_INDEX(i,j,k+1)])/2;
+    }
+    else {
+      dest[n] = 0;
+      dest[n+1] = 0;
+      dest[n+2] = 0;
+    }
 
+    if(++i == ni-1) {
+      i = 0;
+      if(++j == nj-1) {
+        j = 0;
+        k++;
+      }
+    }
+  }
+}
 
-  strm.zalloc = Z_NULL;
-  strm.zfree = Z_NULL;
-  strm.opaque = Z_NULL;
-  ret = deflateInit(&strm, Z_DEFAULT_COMPRESSION);
-  if (ret != Z_OK) {
-    printf("error: could not initialize zlib\n");
+/* the uncompressed stream is a byte count followed by the values.  blocks
+ * are a whole number of 3 bytes, so base64 encodes them one at a time */
+static int vtk_xml_write_uncompressed(FILE *fp, long int count, int size,
+                void (*fill)(struct vtk_xml_field *, long int, long int, double *),
+                struct vtk_xml_field *field) {
+  const long int block_values = VTK_XML_BLOCK / size;
+  long int first, values;
+  uint32_t header;
+  double *in;
+
+  in = malloc(sizeof(double) * block_values);
+  if(in == NULL) {
+    printf("error: could not malloc in vtk_xml_write_uncompressed\n");
     return 1;
   }
 
+  header = count * size;
+  vtk_xml_encode(fp, (unsigned char *) &header, sizeof(uint32_t));
 
-  if(filename == NULL || scalars == NULL) {
-    printf("error: passed null arguments to vtk_xml_write_scalar_grid\n");
+  for(first = 0; first < count; first += block_values) {
+    values = (count - first < block_values) ? count - first : block_values;
+    fill(field, first, values, in);
+    if(size == sizeof(float)) vtk_xml_narrow(in, values);
+    vtk_xml_encode(fp, (unsigned char *) in, values * size);
+  }
+
+  free(in);
+
+  return 0;
+}
+
+/* writes count values from fill as zlib compressed appended data, each
+ * value size bytes.  each block is filled straight into its compressor's
+ * input and the blocks are deflated in parallel */
+static int vtk_xml_write_appended(FILE *fp, long int count, int size,
+                void (*fill)(struct vtk_xml_field *, long int, long int, double *),
+                struct vtk_xml_field *field) {
+  const long int block_values = VTK_XML_BLOCK / size;
+  const size_t chunk = 3 * 65536; /* base64 is written a whole number of 3 bytes at a time */
+  long int blocks, b, first, values;
+  uLong bound = compressBound(VTK_XML_BLOCK);
+  unsigned char *out;
+  uint32_t *header;
+  size_t have, len, pos;
+  int failed = 0;
+
+  if(!vtk_xml_level) return vtk_xml_write_uncompressed(fp, count, size, fill, field);
+
+  blocks = (count + block_values - 1) / block_values;
+
+  header = malloc(sizeof(uint32_t) * (blocks + 3));
+  out = malloc(bound * (blocks > 0 ? blocks : 1));
+  if(header == NULL || out == NULL) {
+    printf("error: could not malloc in vtk_xml_write_appended\n");
+    free(header);
+    free(out);
     return 1;
   }
 
-  vtk_xml_remove(filename);
-  
-  fp = fopen(filename, "w");
+#pragma omp parallel if(vtk_xml_threads > 1) num_threads(vtk_xml_threads) \
+    private(b, first, values)
+  {
+    uLongf block_len;
+    double *in = malloc(sizeof(double) * block_values);
+
+#pragma omp for schedule(dynamic)
+    for(b = 0; b < blocks; b++) {
+      if(in == NULL) {
+        failed = 1;
+        continue;
+      }
 
-  if(fp == NULL) {
-    printf("error: vtk_xml_write_scalar_grid cannot open %s to write\n", filename);
+      first = b * block_values;
+      values = (count - first < block_values) ? count - first : block_values;
+      fill(field, first, values, in);
+      if(size == sizeof(float)) vtk_xml_narrow(in, values);
+
+      block_len = bound;
+      if(compress2(out + b * bound, &block_len, (Bytef *) in, values * size,
+                   vtk_xml_level) != Z_OK)
+        failed = 1;
+      header[b + 3] = block_len;
+    }
+
+    free(in);
+  }
+
+  if(failed) {
+    printf("error: could not deflate %ld values\n", count);
+    free(header);
+    free(out);
     return 1;
   }
 
-  scalars_reorder = malloc(sizeof(double) * ni * nj * nk);
-  in = malloc(sizeof(unsigned char) * ni * nj * nk * 8);
-  out = malloc(sizeof(unsigned char) * ni * nj * nk * 8);
+  header[0] = blocks;
+  header[1] = VTK_XML_BLOCK;
+  header[2] = (count - (blocks - 1) * block_values) * size; /* last block */
+  if(blocks == 0) header[2] = 0;
+
+  /* close up the blocks into one stream */
+  have = 0;
+  for(b = 0; b < blocks; b++) {
+    memmove(out + have, out + b * bound, header[b + 3]);
+    have += header[b + 3];
+  }
+
+  vtk_xml_encode(fp, (unsigned char *) header, sizeof(uint32_t) * (blocks + 3));
+
+  for(pos = 0; pos < have; pos += chunk) {
+    len = (have - pos < chunk) ? have - pos : chunk;
+    vtk_xml_encode(fp, out + pos, len);
+  }
+
+  free(header);
+  free(out);
+
+  return 0;
+}
+
+int vtk_xml_write_scalar_grid(char *filename, char *dataset_name, 
+                          long int ni, long int nj, long int nk,
+                          double oi, double oj, double ok,
+                          double di, double dj, double dk,
+                          double *scalars) {
+  return vtk_xml_write_scalar_piece(filename, dataset_name, 0, 0, ni, ni, nj, nk,
+                                    oi, oj, ok, di, dj, dk, scalars);
+}
+
+/* writes points i0 to i0+ni-1 of a mesh ni_whole points long in i as one
+ * piece of a .pvti.  origin is that of the whole mesh.  single marks a
+ * field only ever visualised, which may be written as Float32 */
+int vtk_xml_write_scalar_piece(char *filename, char *dataset_name, int single,
+                          long int i0, long int ni, long int ni_whole,
+                          long int nj, long int nk,
+                          double oi, double oj, double ok,
+                          double di, double dj, double dk,
+                          double *scalars) {
+  FILE *fp;
+  struct vtk_xml_field field;
+  int ret;
 
-  if(scalars_reorder == NULL || in == NULL || out == NULL) {
-    printf("error: could not malloc in vtk_xml_write_scalar_grid\n");
+  if(filename == NULL || scalars == NULL) {
+    printf("error: passed null arguments to vtk_xml_write_scalar_grid\n");
     return 1;
   }
 
-  fprintf(fp, "<?xml version=\"1.0\"?>\n");
+  fp = vtk_xml_open(filename, "ImageData");
 
-  fprintf(fp, "<VTKFile type=\"ImageData\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt32\" compressor=\"vtkZLibDataCompressor\" > \n");
+  if(fp == NULL) {
+    printf("error: vtk_xml_write_scalar_grid cannot open %s to write\n", filename);
+    return 1;
+  }
   
   fprintf(fp, "<ImageData WholeExtent=\"%ld %ld %ld %ld %ld %ld\" Origin=\"%lf %lf %lf\" Spacing=\"%lf %lf %lf\">\n",
-              0, ni-1, 0, nj-1, 0, nk-1, oi, oj, ok, di, dj, dk);
+              0, ni_whole-1, 0, nj-1, 0, nk-1, oi, oj, ok, di, dj, dk);
   fprintf(fp,"<Piece Extent=\"%ld %ld %ld %ld %ld %ld\">\n",
-              0, ni-1, 0, nj-1, 0, nk-1);
+              i0, i0+ni-1, 0, nj-1, 0, nk-1);
   
   fprintf(fp, "<PointData Scalars=\"%s\">\n",dataset_name);
-  fprintf(fp, "<DataArray type=\"Float64\" Name=\"%s\" format=\"appended\" offset=\"0\"  />\n",dataset_name);
+  fprintf(fp, "<DataArray type=\"%s\" Name=\"%s\" format=\"appended\" offset=\"0\"  />\n",
+              vtk_xml_type(single), dataset_name);
   
   fprintf(fp, "</PointData>\n");
 
@@ -97,73 +318,21 @@ int vtk_xml_write_scalar_grid(char *filename, char *dataset_name,
   fprintf(fp, "</Piece>\n");
   fprintf(fp, "</ImageData>\n");
 
-  fprintf(fp, "<AppendedData encoding=\"base64\">\n_");
-
-  n = 0;
-  for(k=0; k<nk; k++) {
-    for(j=0; j<nj; j++) {
-      for(i=0; i<ni; i++) {
-        scalars_reorder[n] = scalars[CELL_INDEX(i,j,k)];
-        n++;
-      }
-    }
-  }
-
-  memcpy(in, scalars_reorder, ni * nj * nk * 8);
-  strm.avail_in = ni * nj * nk * 8;
-  strm.next_in  = in;
-
-  have = 0;
-
-  strm.avail_out = ni * nj * nk * 8;
-  strm.next_out = out;
-  ret = deflate(&strm, Z_FINISH);    
-  if (ret == Z_STREAM_ERROR) {
-    printf("error: could not deflate scalars\n");
-    free(scalars_reorder);
-    free(in);
-    free(out);
-    return 1;
-  }
-  have = ni * nj * nk * 8 - strm.avail_out;
-
-  if(ret != Z_STREAM_END)    
-  {
-    printf("Could not deflate all data.  Deflated %d from %ld\n",have,ni*nj*nk*8);
-  }
-  else {
-  #ifdef DEBUG
-    printf("Deflated %d from %ld\n",have,ni*nj*nk*8);
-  #endif
-  }
-  deflateEnd(&strm);
-
-  /* first write header */
-  header[0] = 1; // number of blocks
-  header[1] = ni * nj * nk * 8;
-  header[2] = ni * nj * nk * 8;
-  header[3] = have;
-  memcpy(header_char, header, 16);
-  enc = base64_encode(header_char, 16, &out_len);
-  fwrite(enc, 1, out_len, fp);
-  free(enc);
-  
+  fprintf(fp, "<AppendedData encoding=\"%s\">\n_", vtk_xml_raw ? "raw" : "base64");
 
-  /* now write data */
-  enc = base64_encode(out, have, &out_len);
-  fwrite(enc, 1, out_len, fp);
-  free(enc);
+  field.ni = ni;
+  field.nj = nj;
+  field.nk = nk;
+  field.v[0] = scalars;
+  ret = vtk_xml_write_appended(fp, ni * nj * nk, (single && vtk_xml_float32) ? sizeof(float) : sizeof(double),
+                               vtk_xml_fill_scalar, &field);
 
   fprintf(fp, "</AppendedData>\n");
   fprintf(fp, "</VTKFile>\n");
 
   fclose(fp);
 
-  free(scalars_reorder);
-  free(in);
-  free(out);
-
-  return 0;
+  return ret;
 }
 
 
@@ -172,68 +341,42 @@ int vtk_xml_write_vector_grid(char *filename, char *dataset_name,
                           double oi, double oj, double ok,
                           double di, double dj, double dk,
                           double *v1, double *v2, double *v3) {
-  FILE *fp;
-  long int i, j, k, n;
-  const double emf = 0.000001, d;
-  size_t len, out_len;
-  char *enc;
-  uint8_t arr[24];
-  long int count;
-  
-  int ret, flush;
-  unsigned have;
-  z_stream strm;
-  double *v_reorder;
-  unsigned char *in;
-  unsigned char *out;
-
-  uint32_t header[4];
-  unsigned char header_char[16];
-
+  return vtk_xml_write_vector_piece(filename, dataset_name, 0, 0, ni, ni, nj, nk,
+                                    oi, oj, ok, di, dj, dk, v1, v2, v3);
+}
 
-  strm.zalloc = Z_NULL;
-  strm.zfree = Z_NULL;
-  strm.opaque = Z_NULL;
-  ret = deflateInit(&strm, Z_DEFAULT_COMPRESSION);
-  if (ret != Z_OK) {
-    printf("error: could not initialize zlib\n");
-    return 1;
-  }
+/* vectors are averaged onto the ni-1 points between cells, so a piece
+ * of ni cells starting at cell i0 covers points i0 to i0+ni-2 */
+int vtk_xml_write_vector_piece(char *filename, char *dataset_name, int single,
+                          long int i0, long int ni, long int ni_whole,
+                          long int nj, long int nk,
+                          double oi, double oj, double ok,
+                          double di, double dj, double dk,
+                          double *v1, double *v2, double *v3) {
+  FILE *fp;
+  struct vtk_xml_field field;
+  int ret;
 
   if(filename == NULL || v1 == NULL || v2 == NULL || v3 == NULL) {
     printf("error: passed null arguments to vtk_xml_write_vector_grid\n");
     return 1;
   }
 
-  vtk_xml_remove(filename);
-  
-  fp = fopen(filename, "w");
+  fp = vtk_xml_open(filename, "ImageData");
 
   if(fp == NULL) {
     printf("error: vtk_xml_write_vector_grid cannot open %s to write\n", filename);
     return 1;
   }
-
-  v_reorder = malloc(sizeof(double) * (ni-1) * (nj-1) * (nk-1) * 3);
-  in = malloc(sizeof(unsigned char) * (ni-1) * (nj-1) * (nk-1) * 3 * 8);
-  out = malloc(sizeof(unsigned char) * (ni-1) * (nj-1) * (nk-1) * 3 * 8);
-
-  if(v_reorder == NULL || in == NULL || out == NULL) {
-    printf("error: could not malloc in vtk_xml_write_scalar_grid\n");
-    return 1;
-  }
-
-  fprintf(fp, "<?xml version=\"1.0\"?>\n");
-
-  fprintf(fp, "<VTKFile type=\"ImageData\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt32\" compressor=\"vtkZLibDataCompressor\" > \n");
   
   fprintf(fp, "<ImageData WholeExtent=\"%ld %ld %ld %ld %ld %ld\" Origin=\"%lf %lf %lf\" Spacing=\"%lf %lf %lf\">\n",
-              0, ni-2, 0, nj-2, 0, nk-2, oi, oj, ok, di, dj, dk);
+              0, ni_whole-2, 0, nj-2, 0, nk-2, oi, oj, ok, di, dj, dk);
   fprintf(fp,"<Piece Extent=\"%ld %ld %ld %ld %ld %ld\">\n",
-              0, ni-2, 0, nj-2, 0, nk-2);
+              i0, i0+ni-2, 0, nj-2, 0, nk-2);
   
   fprintf(fp, "<PointData Vectors=\"%s\">\n",dataset_name);
-  fprintf(fp, "<DataArray type=\"Float64\" Name=\"%s\" NumberOfComponents=\"3\" format=\"appended\" offset=\"0\"  />\n",dataset_name);
+  fprintf(fp, "<DataArray type=\"%s\" Name=\"%s\" NumberOfComponents=\"3\" format=\"appended\" offset=\"0\"  />\n",
+              vtk_xml_type(single), dataset_name);
   
   fprintf(fp, "</PointData>\n");
 
@@ -244,86 +387,80 @@ int vtk_xml_write_vector_grid(char *filename, char *dataset_name,
   fprintf(fp, "</Piece>\n");
   fprintf(fp, "</ImageData>\n");
 
-  fprintf(fp, "<AppendedData encoding=\"base64\">\n_");
+  fprintf(fp, "<AppendedData encoding=\"%s\">\n_", vtk_xml_raw ? "raw" : "base64");
 
-  n = 0;
-  for(k=0; k<nk-1; k++) {
-    for(j=0; j<nj-1; j++) {
-      for(i=0; i<ni-1; i++) {
+  field.ni = ni;
+  field.nj = nj;
+  field.nk = nk;
+  field.v[0] = v1;
+  field.v[1] = v2;
+  field.v[2] = v3;
+  ret = vtk_xml_write_appended(fp, (ni-1) * (nj-1) * (nk-1) * 3,
+                               (single && vtk_xml_float32) ? sizeof(float) : sizeof(double),
+                               vtk_xml_fill_vector, &field);
 
-        if( (fabs(v1[CELL_INDEX(i,j,k)]) > emf && fabs(v1[CELL_INDEX(i+1,j,k)]) > emf) || 
-            (fabs(v2[CELL_INDEX(i,j,k)]) > emf && fabs(v2[CELL_INDEX(i,j+1,k)]) > emf) ||  
-            (fabs(v3[CELL_INDEX(i,j,k)]) > emf && fabs(v3[CELL_INDEX(i,j,k+1)]) > emf) ) {
+  fprintf(fp, "</AppendedData>\n");
+  fprintf(fp, "</VTKFile>\n");
 
-          v_reorder[n] = (v1[CELL_INDEX(i,j,k)] + v1[CELL_INDEX(i+1,j,k)])/2; n++;
-          v_reorder[n] = (v2[CELL_INDEX(i,j,k)] + v2[CELL_INDEX(i,j+1,k)])/2; n++;
-          v_reorder[n] = (v3[CELL_INDEX(i,j,k)] + v3[CELL_INDEX(i,j,k+1)])/2; n++;
-        }
-        else  {
-          v_reorder[n] = 0; n++;
-          v_reorder[n] = 0; n++;
-          v_reorder[n] = 0; n++;
-        }
-          
+  fclose(fp);
 
-      }
-    }
-  }
+  return ret;
+}
+
+/* writes the .pvti master for pieces written by vtk_xml_write_*_piece.  
+ * piece n covers points i0[n] to i1[n] and is read from <prefix>_<n>.vti 
+ * in the directory of the master */
+int vtk_xml_write_pvti(char *filename, char *dataset_name, char *prefix, int vector,
+                          int single, long int ni_whole, long int nj, long int nk,
+                          double oi, double oj, double ok,
+                          double di, double dj, double dk,
+                          int pieces, long int *i0, long int *i1) {
+  FILE *fp;
+  int n;
 
-  memcpy(in, v_reorder, (ni-1) * (nj-1) * (nk-1) * 8 * 3);
-  strm.avail_in = (ni-1) * (nj-1) * (nk-1) * 8 * 3;
-  strm.next_in  = in;
+  if(filename == NULL || prefix == NULL || i0 == NULL || i1 == NULL) {
+    printf("error: passed null arguments to vtk_xml_write_pvti\n");
+    return 1;
+  }
 
-  have = 0;
+  fp = vtk_xml_open(filename, "PImageData");
 
-  strm.avail_out = (ni-1) * (nj-1) * (nk-1) * 8 * 3;
-  strm.next_out = out;
-  ret = deflate(&strm, Z_FINISH);    
-  if (ret == Z_STREAM_ERROR) {
-    printf("error: could not deflate vectors\n");
-    free(v_reorder);
-    free(in);
-    free(out);
+  if(fp == NULL) {
+    printf("error: vtk_xml_write_pvti cannot open %s to write\n", filename);
     return 1;
   }
-  have = (ni-1) * (nj-1) * (nk-1) * 8 * 3 - strm.avail_out;
 
-  if(ret != Z_STREAM_END)    
-  {
-    printf("Could not deflate all data.  Deflated %d from %ld\n",have,(ni-1) * (nj-1) * (nk-1)*8*3);
+  /* vectors sit on the points between cells, one fewer in each direction */
+  if(vector) {
+    ni_whole--;
+    nj--;
+    nk--;
+  }
+
+  fprintf(fp, "<PImageData WholeExtent=\"%ld %ld %ld %ld %ld %ld\" GhostLevel=\"0\" Origin=\"%lf %lf %lf\" Spacing=\"%lf %lf %lf\">\n",
+              0L, ni_whole-1, 0L, nj-1, 0L, nk-1, oi, oj, ok, di, dj, dk);
+
+  if(vector) {
+    fprintf(fp, "<PPointData Vectors=\"%s\">\n",dataset_name);
+    fprintf(fp, "<PDataArray type=\"%s\" Name=\"%s\" NumberOfComponents=\"3\" />\n",
+                vtk_xml_type(single), dataset_name);
   }
   else {
-  #ifdef DEBUG
-    printf("Deflated %d from %ld\n",have,(ni-1) * (nj-1) * (nk-1)*8*3);
-  #endif
+    fprintf(fp, "<PPointData Scalars=\"%s\">\n",dataset_name);
+    fprintf(fp, "<PDataArray type=\"%s\" Name=\"%s\" />\n", vtk_xml_type(single), dataset_name);
   }
-  deflateEnd(&strm);
-
-  /* first write header */
-  header[0] = 1; // number of blocks
-  header[1] = (ni-1) * (nj-1) * (nk-1) * 8 * 3;
-  header[2] = (ni-1) * (nj-1) * (nk-1) * 8 * 3;
-  header[3] = have;
-  memcpy(header_char, header, 16);
-  enc = base64_encode(header_char, 16, &out_len);
-  fwrite(enc, 1, out_len, fp);
-  free(enc);
-  
+  fprintf(fp, "</PPointData>\n");
 
-  /* now write data */
-  enc = base64_encode(out, have, &out_len);
-  fwrite(enc, 1, out_len, fp);
-  free(enc);
+  for(n = 0; n < pieces; n++) {
+    fprintf(fp, "<Piece Extent=\"%ld %ld %ld %ld %ld %ld\" Source=\"%s_%d.vti\" />\n",
+                i0[n], i1[n], 0L, nj-1, 0L, nk-1, prefix, n);
+  }
 
-  fprintf(fp, "</AppendedData>\n");
+  fprintf(fp, "</PImageData>\n");
   fprintf(fp, "</VTKFile>\n");
 
   fclose(fp);
 
-  free(v_reorder);
-  free(in);
-  free(out);
-
   return 0;
 }
 
@@ -50,6 +50,25 @@ int vtk_xml_compressed_write_integer_grid(char *filename_vtk, char *dataset_name
                           double di, double dj, double dk,
                           int *scalars); 
 
+int vtk_xml_write_scalar_piece(char *filename, char *dataset_name, int single,
+                          long int i0, long int ni, long int ni_whole,
+                          long int nj, long int nk,
+                          double oi, double oj, double ok,
+                          double di, double dj, double dk,
+                          double *scalars);
+int vtk_xml_write_vector_piece(char *filename, char *dataset_name, int single,
+                          long int i0, long int ni, long int ni_whole,
+                          long int nj, long int nk,
+                          double oi, double oj, double ok,
+                          double di, double dj, double dk,
+                          double *v1, double *v2, double *v3);
+int vtk_xml_write_pvti(char *filename, char *dataset_name, char *prefix, int vector,
+                          int single, long int ni_whole, long int nj, long int nk,
+                          double oi, double oj, double ok,
+                          double di, double dj, double dk,
+                          int pieces, long int *i0, long int *i1);
+
+void vtk_xml_set_format(int level, int raw, int float32, int threads);
 void vtk_xml_remove(char *filename);
 int vtk_xml_decompress(const char *cstr);
 #endif
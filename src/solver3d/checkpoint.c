@@ -0,0 +1,367 @@
+/* checkpoint.c
+ *
+ * binary checkpoints for restarting the solver.  <t>/checkpoint.bin holds
+ * a header followed by P, u, v, w, vof, n_vof and for k-epsilon runs k, E
+ * and nu_t, each as a raw little-endian array over the whole mesh.  arrays
+ * run i-major so a slab is one contiguous block: every rank writes its own
+ * planes and reads back only its own i-range from a memory map.  big-endian
+ * hosts swap on the way in and out
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <mpi.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include "mesh.h"
+#include "kE.h"
+#include "solver.h"
+#include "checkpoint.h"
+
+#define CHECKPOINT_MAGIC "CFDCHK1"
+#define CHECKPOINT_BYTE_ORDER 0x01020304
+
+struct checkpoint_header {
+  char magic[8];
+  uint32_t byte_order; /* reads as CHECKPOINT_BYTE_ORDER once swapped to host order */
+  uint32_t turbulence; /* k, E and nu_t follow n_vof */
+  int64_t imax, jmax, kmax;
+  double origin[3];
+  double del[3];
+  double t, delt;
+  char reserved[24]; /* pads the header to 128 bytes */
+};
+
+enum checkpoint_arrays { checkpoint_P, checkpoint_u, checkpoint_v, checkpoint_w,
+                         checkpoint_vof, checkpoint_n_vof, checkpoint_k, checkpoint_E,
+                         checkpoint_nu_t, checkpoint_count };
+
+/* an open checkpoint, mapped where mmap is available */
+struct checkpoint_file {
+  const char *map;
+  int64_t size;
+  FILE *fp;
+};
+
+static int checkpoint_big_endian() {
+  const uint16_t one = 1;
+
+  return *(const unsigned char *) &one == 0;
+}
+
+/* reverses the bytes of count values of size bytes each, between the
+ * little-endian file order and the order of a big-endian host */
+static void checkpoint_swap(void *data, size_t size, long int count) {
+  unsigned char *p = data, c;
+  long int n;
+  size_t b;
+
+  for(n = 0; n < count; n++, p += size) {
+    for(b = 0; b < size / 2; b++) {
+      c = p[b];
+      p[b] = p[size - 1 - b];
+      p[size - 1 - b] = c;
+    }
+  }
+}
+
+static void checkpoint_swap_header(struct checkpoint_header *header) {
+  checkpoint_swap(&header->byte_order, sizeof(uint32_t), 1);
+  checkpoint_swap(&header->turbulence, sizeof(uint32_t), 1);
+  checkpoint_swap(&header->imax, sizeof(int64_t), 1);
+  checkpoint_swap(&header->jmax, sizeof(int64_t), 1);
+  checkpoint_swap(&header->kmax, sizeof(int64_t), 1);
+  checkpoint_swap(header->origin, sizeof(double), 3);
+  checkpoint_swap(header->del, sizeof(double), 3);
+  checkpoint_swap(&header->t, sizeof(double), 1);
+  checkpoint_swap(&header->delt, sizeof(double), 1);
+}
+
+/* byte offset of plane i of an array.  n_vof is stored as int32,
+ * everything else as doubles */
+static int64_t checkpoint_offset(struct mesh_data *mesh, int array, long int i) {
+  int64_t plane = (int64_t) mesh->jmax * mesh->kmax;
+  int64_t cells = plane * mesh->imax;
+  int64_t offset = sizeof(struct checkpoint_header);
+
+  if(array > checkpoint_n_vof)
+    offset += cells * sizeof(int32_t) + (array - 1) * cells * sizeof(double);
+  else
+    offset += array * cells * sizeof(double);
+
+  if(array == checkpoint_n_vof) return offset + i * plane * sizeof(int32_t);
+  return offset + i * plane * sizeof(double);
+}
+
+static double *checkpoint_field(struct mesh_data *mesh, int array) {
+  struct kE_data *kE = mesh->turbulence_model;
+
+  switch(array) {
+  case checkpoint_P:
+    return mesh->P;
+  case checkpoint_u:
+    return mesh->u;
+  case checkpoint_v:
+    return mesh->v;
+  case checkpoint_w:
+    return mesh->w;
+  case checkpoint_vof:
+    return mesh->vof;
+  case checkpoint_k:
+    return kE->k;
+  case checkpoint_E:
+    return kE->E;
+  case checkpoint_nu_t:
+    return kE->nu_t;
+  }
+
+  return NULL;
+}
+
+int checkpoint_write(struct solver_data *solver) {
+  struct mesh_data *mesh = solver->mesh;
+  struct checkpoint_header header;
+  MPI_File fh;
+  MPI_Status status;
+  char filename[256];
+  long int first, planes, cells, n;
+  int32_t *n_vof;
+  double *field;
+  int array, arrays, swap, rc = MPI_SUCCESS;
+  #ifndef _WIN32
+  mode_t process_mask;
+  #endif
+
+  sprintf(filename, "%4.3lf", solver->t);
+  if(!solver->rank) {
+    #ifdef _WIN32
+    mkdir(filename);
+    #else
+    process_mask = umask(0);
+    mkdir(filename, S_IRWXU | S_IRWXG | S_IRWXO);
+    umask(process_mask);
+    #endif
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+  sprintf(filename, "%4.3lf/checkpoint.bin", solver->t);
+
+  /* a piece writes the planes it owns, a single process the whole mesh */
+  first = 0;
+  planes = mesh->imax;
+  if(mesh->piece >= 0) {
+    first = mesh_piece_first(mesh);
+    planes = mesh_piece_planes(mesh);
+  }
+  cells = planes * mesh->jmax * mesh->kmax;
+  arrays = (mesh->turbulence_model != NULL) ? checkpoint_count : checkpoint_k;
+  swap = checkpoint_big_endian();
+
+  n_vof = malloc(sizeof(int32_t) * cells);
+  if(n_vof == NULL) {
+    printf("error: could not allocate memory for checkpoint_write\n");
+    return 1;
+  }
+
+  if(MPI_File_open(MPI_COMM_WORLD, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                   MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+    if(!solver->rank) printf("error: checkpoint_write cannot open %s to write\n", filename);
+    free(n_vof);
+    return 1;
+  }
+  MPI_File_set_size(fh, checkpoint_offset(mesh, arrays, 0));
+
+  if(!solver->rank) {
+    memset(&header, 0, sizeof(header));
+    strcpy(header.magic, CHECKPOINT_MAGIC);
+    header.byte_order = CHECKPOINT_BYTE_ORDER;
+    header.turbulence = (mesh->turbulence_model != NULL);
+    header.imax = mesh->imax;
+    header.jmax = mesh->jmax;
+    header.kmax = mesh->kmax;
+    header.origin[0] = mesh->origin[0];
+    header.origin[1] = mesh->origin[1];
+    header.origin[2] = mesh->origin[2];
+    header.del[0] = mesh->delx;
+    header.del[1] = mesh->dely;
+    header.del[2] = mesh->delz;
+    header.t = solver->t;
+    header.delt = solver->delt;
+    if(swap) checkpoint_swap_header(&header);
+
+    rc |= MPI_File_write_at(fh, 0, &header, sizeof(header), MPI_BYTE, &status);
+  }
+
+  for(array = 0; array < arrays; array++) {
+    if(array == checkpoint_n_vof) {
+      for(n = 0; n < cells; n++)
+        n_vof[n] = mesh->n_vof[n + first * mesh->jmax * mesh->kmax];
+      if(swap) checkpoint_swap(n_vof, sizeof(int32_t), cells);
+
+      rc |= MPI_File_write_at(fh, checkpoint_offset(mesh, array, mesh->i_start + first),
+                              n_vof, cells, MPI_INT32_T, &status);
+      continue;
+    }
+
+    /* the slab is swapped in place for the write and swapped back after */
+    field = checkpoint_field(mesh, array) + first * mesh->jmax * mesh->kmax;
+    if(swap) checkpoint_swap(field, sizeof(double), cells);
+    rc |= MPI_File_write_at(fh, checkpoint_offset(mesh, array, mesh->i_start + first),
+                            field, cells, MPI_DOUBLE, &status);
+    if(swap) checkpoint_swap(field, sizeof(double), cells);
+  }
+
+  MPI_File_close(&fh);
+  free(n_vof);
+
+  if(rc != MPI_SUCCESS) {
+    printf("error: checkpoint_write failed writing %s on rank %d\n", filename, solver->rank);
+    return 1;
+  }
+
+  return 0;
+}
+
+static int checkpoint_open(struct checkpoint_file *file, char *filename) {
+  #ifndef _WIN32
+  struct stat st;
+  void *map;
+  int fd;
+
+  file->fp = NULL;
+  fd = open(filename, O_RDONLY);
+  if(fd < 0) return 1;
+  if(fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return 1;
+  }
+  map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if(map == MAP_FAILED) return 1;
+
+  file->map = map;
+  file->size = st.st_size;
+  #else
+  file->map = NULL;
+  file->fp = fopen(filename, "rb");
+  if(file->fp == NULL) return 1;
+  fseek(file->fp, 0, SEEK_END);
+  file->size = ftell(file->fp);
+  #endif
+
+  return 0;
+}
+
+static int checkpoint_fetch(struct checkpoint_file *file, int64_t offset, size_t bytes, void *dest) {
+  if(offset + (int64_t) bytes > file->size) return 1;
+
+  if(file->map != NULL) {
+    memcpy(dest, file->map + offset, bytes);
+    return 0;
+  }
+
+  if(fseek(file->fp, offset, SEEK_SET) != 0) return 1;
+  if(fread(dest, 1, bytes, file->fp) != bytes) return 1;
+
+  return 0;
+}
+
+static void checkpoint_close(struct checkpoint_file *file) {
+  #ifndef _WIN32
+  munmap((void *) file->map, file->size);
+  #else
+  fclose(file->fp);
+  #endif
+}
+
+/* fills the slab held by this process from <timestep>/checkpoint.bin and
+ * restores t and delt.  returns 1 if there is no usable checkpoint,
+ * leaving the caller to fall back to the csv results */
+int checkpoint_read(struct solver_data *solver, double timestep) {
+  struct mesh_data *mesh = solver->mesh;
+  struct checkpoint_file file;
+  struct checkpoint_header header;
+  char filename[256];
+  long int i_start, planes, cells, n;
+  int32_t *n_vof;
+  int array, arrays, swap, failed = 0;
+
+  sprintf(filename, "%4.3lf/checkpoint.bin", timestep);
+  if(checkpoint_open(&file, filename)) return 1;
+  swap = checkpoint_big_endian();
+
+  failed = checkpoint_fetch(&file, 0, sizeof(header), &header);
+  if(!failed && swap) checkpoint_swap_header(&header);
+  if(failed || strncmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 ||
+     header.byte_order != CHECKPOINT_BYTE_ORDER) {
+    printf("error: %s is not a checkpoint\n", filename);
+    checkpoint_close(&file);
+    return 1;
+  }
+
+  if(header.imax != mesh->imax || header.jmax != mesh->jmax || header.kmax != mesh->kmax) {
+    printf("error: checkpoint %s is for a %ld x %ld x %ld mesh\n", filename,
+           (long int) header.imax, (long int) header.jmax, (long int) header.kmax);
+    checkpoint_close(&file);
+    return 1;
+  }
+
+  if(mesh->turbulence_model != NULL && !header.turbulence) {
+    printf("error: checkpoint %s has no turbulence values\n", filename);
+    checkpoint_close(&file);
+    return 1;
+  }
+
+  i_start = 0;
+  planes = mesh->imax;
+  if(mesh->piece >= 0) {
+    i_start = mesh->i_start;
+    planes = mesh->i_range;
+  }
+  cells = planes * mesh->jmax * mesh->kmax;
+  arrays = (mesh->turbulence_model != NULL) ? checkpoint_count : checkpoint_k;
+
+  n_vof = malloc(sizeof(int32_t) * cells);
+  if(n_vof == NULL) {
+    printf("error: could not allocate memory for checkpoint_read\n");
+    checkpoint_close(&file);
+    return 1;
+  }
+
+  for(array = 0; array < arrays && !failed; array++) {
+    if(array == checkpoint_n_vof) {
+      failed = checkpoint_fetch(&file, checkpoint_offset(mesh, array, i_start),
+                                sizeof(int32_t) * cells, n_vof);
+      if(!failed && swap) checkpoint_swap(n_vof, sizeof(int32_t), cells);
+      for(n = 0; n < cells && !failed; n++)
+        mesh->n_vof[n] = n_vof[n];
+      continue;
+    }
+
+    failed = checkpoint_fetch(&file, checkpoint_offset(mesh, array, i_start),
+                              sizeof(double) * cells, checkpoint_field(mesh, array));
+    if(!failed && swap) checkpoint_swap(checkpoint_field(mesh, array), sizeof(double), cells);
+  }
+
+  free(n_vof);
+  checkpoint_close(&file);
+
+  if(failed) {
+    printf("error: checkpoint %s is truncated\n", filename);
+    return 1;
+  }
+
+  solver->t = header.t;
+  solver->delt = header.delt;
+
+  if(!solver->rank) printf("restarting from checkpoint %s at t = %lf\n", filename, solver->t);
+
+  return 0;
+}
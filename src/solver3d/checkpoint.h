@@ -0,0 +1,14 @@
+/* checkpoint.h
+ *
+ * binary checkpoints for restarting the solver
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "solver_data.h"
+
+int checkpoint_write(struct solver_data *solver);
+int checkpoint_read(struct solver_data *solver, double timestep);
+
+#endif
@@ -25,16 +25,17 @@
 #include "vector_macros.h"
   
 static struct kE_data kE, kE_n;
-
-#define k(l,m,n) kE.k[mesh_index(solver->mesh, l, m, n)]
-#define E(l,m,n) kE.E[mesh_index(solver->mesh, l, m, n)]
-#define nu_t(l,m,n) kE.nu_t[mesh_index(solver->mesh, l, m, n)]
-#define k_N(l,m,n) kE_n.k[mesh_index(solver->mesh, l, m, n)]
-#define E_N(l,m,n) kE_n.E[mesh_index(solver->mesh, l, m, n)]
-#define nu_t_N(l,m,n) kE_n.nu_t[mesh_index(solver->mesh, l, m, n)]
-#define tau_x(l,m,n) kE.tau_x[mesh_index(solver->mesh, l, m, n)]
-#define tau_y(l,m,n) kE.tau_y[mesh_index(solver->mesh, l, m, n)]
-#define tau_z(l,m,n) kE.tau_z[mesh_index(solver->mesh, l, m, n)]
+static struct solver_halo kE_halo; /* k, E and nu_t */
+
+#define k(l,m,n) kE.k[mesh_offset(solver->mesh, l, m, n)]
+#define E(l,m,n) kE.E[mesh_offset(solver->mesh, l, m, n)]
+#define nu_t(l,m,n) kE.nu_t[mesh_offset(solver->mesh, l, m, n)]
+#define k_N(l,m,n) kE_n.k[mesh_offset(solver->mesh, l, m, n)]
+#define E_N(l,m,n) kE_n.E[mesh_offset(solver->mesh, l, m, n)]
+#define nu_t_N(l,m,n) kE_n.nu_t[mesh_offset(solver->mesh, l, m, n)]
+#define tau_x(l,m,n) kE.tau_x[mesh_offset(solver->mesh, l, m, n)]
+#define tau_y(l,m,n) kE.tau_y[mesh_offset(solver->mesh, l, m, n)]
+#define tau_z(l,m,n) kE.tau_z[mesh_offset(solver->mesh, l, m, n)]
 
 #ifdef DEBUG
 float kk(struct solver_data *solver, long int i,long int j,long int k);
@@ -318,7 +319,7 @@ int kE_init(struct solver_data *solver) {
     return 1;
   }
   
-  if(!solver->rank) {
+  if(!solver->rank || solver->distributed) {
     kE_set_internal(solver, 0.0001, 0);
   }
   kE_length();
@@ -404,7 +405,7 @@ int kE_set_internal(struct solver_data *solver, double k, double E) {
   
   E_limit = kE.C_mu * pow(k, 1.5) / kE.length;
 
-  if(!solver->rank) irange = IMAX;
+  if(!solver->rank && !solver->distributed) irange = IMAX;
   else irange = IRANGE;
 
   for(l=0; l<irange; l++) {
@@ -486,11 +487,12 @@ int kE_boundaries(struct solver_data *solver) {
   }
   for(j=0; j<JMAX; j++) {
     for(k=0; k<KMAX; k++) {
-      if(ISTART == 0) {
+      if(solver_mpi_wall(solver, 0)) {
         k(0,j,k) = k(1,j,k);
         E(0,j,k) = E(1,j,k);
         nu_t(0,j,k) = nu_t(1,j,k);
-      } else if(ISTART + IRANGE == IMAX) {
+      }
+      if(solver_mpi_wall(solver, 1)) {
         k(IRANGE-1,j,k) = k(IRANGE-2,j,k);
         E(IRANGE-1,j,k) = E(IRANGE-2,j,k);
         nu_t(IRANGE-1,j,k) = nu_t(IRANGE-2,j,k);
@@ -610,6 +612,9 @@ int kE_tau(struct solver_data *solver) {
   double E_limit;
   const double del[3] = { DELX, DELY, DELZ };
   
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(i, j, k, im1, jm1, km1, d, u_t, wall_n, u_c, mag, tau, u_perp_n, u_perp_c, u_parr_c, \
+            u_parr, E_limit) schedule(dynamic, 4)
   for(i=1; i<IRANGE; i++) {
     for(j=1; j<JMAX; j++) {
       for(k=1; k<KMAX; k++) {
@@ -765,149 +770,182 @@ int kE_loop_explicit(struct solver_data *solver) {
   double delk, delE, Production, Diffusion_k, Diffusion_E, nu_t, nu_eff, E_limit;
   double dkdx, dkdy, dkdz, dEdx, dEdy, dEdz;
   double dvdx, dudy, dudz, dwdx, dvdz, dwdy;
-  long int i,j,k;
+  long int i,j,k,c,n,nplanes;
+  int pass;
+
+  /* c is the offset of cell i,j,k; neighbours are c +/- si (i), sj (j) and 1 (k) */
+  const struct mesh_view view = mesh_view(solver->mesh, kE.k);
+  const long int si = view.si, sj = view.sj;
+  const double * const u = solver->mesh->u;
+  const double * const v = solver->mesh->v;
+  const double * const w = solver->mesh->w;
+  const double * const fv = solver->mesh->fv;
+  const double * const vof = solver->mesh->vof;
+  const enum cell_boundaries * const n_vof = solver->mesh->n_vof;
+  const double * const kn = kE_n.k;
+  const double * const En = kE_n.E;
+  const double rdx = RDX, rdy = RDY, rdz = RDZ;
+  const long int irange = IRANGE, jmax = JMAX, kmax = KMAX;
   
-  for(i=1; i<IRANGE-1; i++) {
-    for(j=1; j<JMAX-1; j++) {
-      for(k=1; k<KMAX-1; k++) {
+  /* planes 1 and irange-2 read the halo velocities, so the inner planes
+   * are done first while the halo exchange is in flight */
+  for(pass=0; pass<2; pass++) {
+    if(pass == 0)
+      nplanes = max(irange-4, 0);
+    else {
+      solver_halo_end(solver, &solver->halo);
+      nplanes = min(irange-2, 2);
+    }
 
-        /* exit conditions */
-        if(FV(i,j,k) <= (1-solver->emf) || VOF(i,j,k) < solver->emf)
-          continue;
-      	if(N_VOF(i,j,k) != 0) continue;
-
-/*    K upwind */
-        if(U(i-1,j,k) >= 0) 
-          dkdx = RDX * 
-                 (k_N(i,j,k) - k_N(i-1,j,k));
-        else
-          dkdx = RDX * 
-                 (k_N(i,j,k) - k_N(i+1,j,k));
-                 
-        if(V(i,j-1,k) >= 0)                       
-          dkdy = RDY *
-                 (k_N(i,j,k) - k_N(i,j-1,k));
-        else
-          dkdy = RDY * 
-                 (k_N(i,j,k) - k_N(i,j+1,k));
-        
-        if(W(i,j,k-1) >= 0)                     
-          dkdz = RDZ *
-                 (k_N(i,j,k) - k_N(i,j,k-1)); 
-        else
-          dkdz = RDZ *
-                 (k_N(i,j,k) - k_N(i,j,k+1));                 
-                 
-        nu_t = nu_t_N(i,j,k);
-        nu_eff = nu_t + solver->nu / kE.sigma_k;
-        nu_eff = max(nu_eff, solver->nu);
-
-        Diffusion_k = pow(RDX,2) * ( (k_N(i+1,j,k) - k_N(i,j,k)) - 
-                                     (k_N(i  ,j,k) - k_N(i-1,j,k)) );
-        Diffusion_k +=pow(RDY,2) * ( (k_N(i,j+1,k) - k_N(i,j,k)) - 
-                                     (k_N(i  ,j,k) - k_N(i,j-1,k)) );
-        Diffusion_k +=pow(RDZ,2) * ( (k_N(i,j,k+1) - k_N(i,j,k)) - 
-                                     (k_N(i  ,j,k) - k_N(i,j,k-1)) );
-        Diffusion_k *= nu_eff * (1.0 / FV(i,j,k));
-
-        dvdx = (V(i+1,j,k) + V(i+1,j-1,k) + V(i,j,k) + V(i,j-1,k))/4 - 
-               (V(i-1,j,k) + V(i-1,j-1,k) + V(i,j,k) + V(i,j-1,k))/4;
-        dvdx *= RDX;
-
-        dudy = (U(i,j+1,k) + U(i-1,j+1,k) + U(i,j,k) + U(i-1,j,k))/4 -
-               (U(i,j-1,k) + U(i-1,j-1,k) + U(i,j,k) + U(i-1,j,k))/4;
-        dudy *= RDY;
-
-        dudz = (U(i,j,k+1) + U(i-1,j,k+1) + U(i,j,k) + U(i-1,j,k))/4 -
-               (U(i,j,k-1) + U(i-1,j,k-1) + U(i,j,k) + U(i-1,j,k))/4;
-        dudz *= RDZ;
-
-        dwdx = (W(i+1,j,k) + W(i+1,j,k-1) + W(i,j,k) + W(i,j,k-1))/4 -
-               (W(i-1,j,k) + W(i-1,j,k-1) + W(i,j,k) + W(i,j,k-1))/4;
-        dwdx *= RDX;
-
-        dvdz = (V(i,j,k+1) + V(i,j-1,k+1) + V(i,j,k) + V(i,j-1,k))/4 -
-               (V(i,j,k-1) + V(i,j-1,k-1) + V(i,j,k) + V(i,j-1,k))/4;
-        dvdz *= RDZ;
-
-        dwdy = (W(i,j+1,k) + W(i,j+1,k-1) + W(i,j,k) + W(i,j,k-1))/4 -
-               (W(i,j-1,k) + W(i,j-1,k-1) + W(i,j,k) + W(i,j,k-1))/4;
-        dwdy *= RDY;
-        
-        Production = nu_t * (1.0 / FV(i,j,k)) * 
-                     ( pow((U(i,j,k) - U(i-1,j,k)) * RDX, 2) + 
-                       pow((V(i,j,k) - V(i,j-1,k)) * RDY, 2) +
-                       pow((W(i,j,k) - W(i,j,k-1)) * RDZ, 2) +
-                       (dvdx + dudy) * (dvdx + dudy) +
-                       (dudz + dwdx) * (dudz + dwdx) +
-                       (dvdz + dwdy) * (dvdz + dwdy) );
-
-        delk = ( -1.0 / FV(i,j,k)) * 
-                ( fabs((U(i,j,k) + U(i-1,j,k)) / 2) * dkdx + /* TESTING FABS 03/07/16 */
-                  fabs((V(i,j,k) + V(i,j-1,k)) / 2) * dkdy + 
-                  fabs((W(i,j,k) + W(i,j,k-1)) / 2) * dkdz ) +
-                Production + Diffusion_k - E_N(i,j,k);
-
-/*    E upwind */
-        if(U(i-1,j,k) >= 0) 
-          dEdx = RDX * 
-                 (E_N(i,j,k) - E_N(i-1,j,k));
-        else
-          dEdx = RDX * 
-                 (E_N(i,j,k) - E_N(i+1,j,k));
-                 
-        if(V(i,j-1,k) >= 0)                       
-          dEdy = RDY *
-                 (E_N(i,j,k) - E_N(i,j-1,k));
-        else
-          dEdy = RDY * 
-                 (E_N(i,j,k) - E_N(i,j+1,k));
-        
-        if(W(i,j,k-1) >= 0)                     
-          dEdz = RDZ *
-                 (E_N(i,j,k) - E_N(i,j,k-1)); 
-        else
-          dEdz = RDZ *
-                 (E_N(i,j,k) - E_N(i,j,k+1));  
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(i, n, j, k, c, delk, delE, Production, Diffusion_k, Diffusion_E, nu_t, nu_eff, E_limit, \
+            dkdx, dkdy, dkdz, dEdx, dEdy, dEdz, dvdx, dudy, dudz, dwdx, dvdz, dwdy) schedule(dynamic, 4)
+    for(n=0; n<nplanes; n++) {
+      i = (pass == 0) ? n + 2 : (n ? irange-2 : 1);
+      for(j=1; j<jmax-1; j++) {
+        for(k=1; k<kmax-1; k++) {
+          c = MESH_VIEW_OFFSET(view, i, j, k);
+
+          /* exit conditions */
+          if(fv[c] <= (1-solver->emf) || vof[c] < solver->emf)
+            continue;
+        	if(n_vof[c] != 0) continue;
+
+  /*    K upwind */
+          if(u[c-si] >= 0) 
+            dkdx = rdx * 
+                   (kn[c] - kn[c-si]);
+          else
+            dkdx = rdx * 
+                   (kn[c] - kn[c+si]);
+                   
+          if(v[c-sj] >= 0)                       
+            dkdy = rdy *
+                   (kn[c] - kn[c-sj]);
+          else
+            dkdy = rdy * 
+                   (kn[c] - kn[c+sj]);
+          
+          if(w[c-1] >= 0)                     
+            dkdz = rdz *
+                   (kn[c] - kn[c-1]); 
+          else
+            dkdz = rdz *
+                   (kn[c] - kn[c+1]);                 
+                   
+          nu_t = kE_n.nu_t[c];
+          nu_eff = nu_t + solver->nu / kE.sigma_k;
+          nu_eff = max(nu_eff, solver->nu);
+
+          Diffusion_k = pow(rdx,2) * ( (kn[c+si] - kn[c]) - 
+                                       (kn[c]    - kn[c-si]) );
+          Diffusion_k +=pow(rdy,2) * ( (kn[c+sj] - kn[c]) - 
+                                       (kn[c]    - kn[c-sj]) );
+          Diffusion_k +=pow(rdz,2) * ( (kn[c+1]  - kn[c]) - 
+                                       (kn[c]    - kn[c-1]) );
+          Diffusion_k *= nu_eff * (1.0 / fv[c]);
+
+          dvdx = (v[c+si] + v[c+si-sj] + v[c] + v[c-sj])/4 - 
+                 (v[c-si] + v[c-si-sj] + v[c] + v[c-sj])/4;
+          dvdx *= rdx;
+
+          dudy = (u[c+sj] + u[c-si+sj] + u[c] + u[c-si])/4 -
+                 (u[c-sj] + u[c-si-sj] + u[c] + u[c-si])/4;
+          dudy *= rdy;
+
+          dudz = (u[c+1] + u[c-si+1] + u[c] + u[c-si])/4 -
+                 (u[c-1] + u[c-si-1] + u[c] + u[c-si])/4;
+          dudz *= rdz;
+
+          dwdx = (w[c+si] + w[c+si-1] + w[c] + w[c-1])/4 -
+                 (w[c-si] + w[c-si-1] + w[c] + w[c-1])/4;
+          dwdx *= rdx;
+
+          dvdz = (v[c+1] + v[c-sj+1] + v[c] + v[c-sj])/4 -
+                 (v[c-1] + v[c-sj-1] + v[c] + v[c-sj])/4;
+          dvdz *= rdz;
+
+          dwdy = (w[c+sj] + w[c+sj-1] + w[c] + w[c-1])/4 -
+                 (w[c-sj] + w[c-sj-1] + w[c] + w[c-1])/4;
+          dwdy *= rdy;
+          
+          Production = nu_t * (1.0 / fv[c]) * 
+                       ( pow((u[c] - u[c-si]) * rdx, 2) + 
+                         pow((v[c] - v[c-sj]) * rdy, 2) +
+                         pow((w[c] - w[c-1]) * rdz, 2) +
+                         (dvdx + dudy) * (dvdx + dudy) +
+                         (dudz + dwdx) * (dudz + dwdx) +
+                         (dvdz + dwdy) * (dvdz + dwdy) );
+
+          delk = ( -1.0 / fv[c]) * 
+                  ( fabs((u[c] + u[c-si]) / 2) * dkdx + /* TESTING FABS 03/07/16 */
+                    fabs((v[c] + v[c-sj]) / 2) * dkdy + 
+                    fabs((w[c] + w[c-1]) / 2) * dkdz ) +
+                  Production + Diffusion_k - En[c];
+
+  /*    E upwind */
+          if(u[c-si] >= 0) 
+            dEdx = rdx * 
+                   (En[c] - En[c-si]);
+          else
+            dEdx = rdx * 
+                   (En[c] - En[c+si]);
+                   
+          if(v[c-sj] >= 0)                       
+            dEdy = rdy *
+                   (En[c] - En[c-sj]);
+          else
+            dEdy = rdy * 
+                   (En[c] - En[c+sj]);
+          
+          if(w[c-1] >= 0)                     
+            dEdz = rdz *
+                   (En[c] - En[c-1]); 
+          else
+            dEdz = rdz *
+                   (En[c] - En[c+1]);  
+                   
+          nu_eff = nu_t + solver->nu / kE.sigma_E;
+          nu_eff = max(nu_eff, solver->nu);
+
+
+          Diffusion_E = pow(rdx,2) * ( (En[c+si] - En[c]) - 
+                                       (En[c]    - En[c-si]) );
+          Diffusion_E +=pow(rdy,2) * ( (En[c+sj] - En[c]) - 
+                                       (En[c]    - En[c-sj]) );
+          Diffusion_E +=pow(rdz,2) * ( (En[c+1]  - En[c]) - 
+                                       (En[c]    - En[c-1]) );
+          Diffusion_E *= nu_eff * (1.0 / fv[c]);
+                        
+          delE = ( -1.0 / fv[c]) *
+                  ( fabs((u[c] + u[c-si]) / 2) * dEdx +  
+                    fabs((v[c] + v[c-sj]) / 2) * dEdy + 
+                    fabs((w[c] + w[c-1]) / 2) * dEdz ) + 
+                 ( En[c] / kn[c] ) * 
+                    ( kE.C1E * Production - kE.C2E * En[c]) +
+                 Diffusion_E;
+          
                  
-        nu_eff = nu_t + solver->nu / kE.sigma_E;
-        nu_eff = max(nu_eff, solver->nu);
-
-
-        Diffusion_E = pow(RDX,2) * ( (E_N(i+1,j,k) - E_N(i,j,k)) - 
-                                     (E_N(i  ,j,k) - E_N(i-1,j,k)) );
-        Diffusion_E +=pow(RDY,2) * ( (E_N(i,j+1,k) - E_N(i,j,k)) - 
-                                     (E_N(i  ,j,k) - E_N(i,j-1,k)) );
-        Diffusion_E +=pow(RDZ,2) * ( (E_N(i,j,k+1) - E_N(i,j,k)) - 
-                                     (E_N(i  ,j,k) - E_N(i,j,k-1)) );
-        Diffusion_E *= nu_eff * (1.0 / FV(i,j,k));
-                      
-        delE = ( -1.0 / FV(i,j,k)) *
-                ( fabs((U(i,j,k) + U(i-1,j,k)) / 2) * dEdx +  
-                  fabs((V(i,j,k) + V(i,j-1,k)) / 2) * dEdy + 
-                  fabs((W(i,j,k) + W(i,j,k-1)) / 2) * dEdz ) + 
-               ( E_N(i,j,k) / k_N(i,j,k) ) * 
-                  ( kE.C1E * Production - kE.C2E * E_N(i,j,k)) +
-               Diffusion_E;
-        
-               
-        if(isnan(delk)) delk = 0;
-        k(i,j,k) = max(k_N(i,j,k) + delk * solver->delt, 0);
-        E_limit = kE.C_mu * pow(k(i,j,k), 1.5) / kE.length;
-                
-        if(isnan(delE) || (E_N(i,j,k) + delE * solver->delt) < 0.0000001) delE = 0;        
-        E(i,j,k) = max(E_limit, E_N(i,j,k) + delE * solver->delt);
-        nu_t(i,j,k) = max(kE.C_mu * pow(k(i,j,k),2) / E(i,j,k),0);
+          if(isnan(delk)) delk = 0;
+          kE.k[c] = max(kn[c] + delk * solver->delt, 0);
+          E_limit = kE.C_mu * pow(kE.k[c], 1.5) / kE.length;
+                  
+          if(isnan(delE) || (En[c] + delE * solver->delt) < 0.0000001) delE = 0;        
+          kE.E[c] = max(E_limit, En[c] + delE * solver->delt);
+          kE.nu_t[c] = max(kE.C_mu * pow(kE.k[c],2) / kE.E[c],0);
 
+        }
       }
     }
   }
 
   kE_boundaries(solver);
 
-  solver_sendrecv_edge(solver, kE.k);
-  solver_sendrecv_edge(solver, kE.E);
-  solver_sendrecv_edge(solver, kE.nu_t);
+  if(kE_halo.fields == 0) {
+    double *fields[3] = { kE.k, kE.E, kE.nu_t };
+    if(solver_halo_init(solver, &kE_halo, 5, 3, fields)) return 1;
+  }
+  solver_halo_exchange(solver, &kE_halo);
 
   kE_copy(solver);
 
@@ -916,6 +954,7 @@ int kE_loop_explicit(struct solver_data *solver) {
 
 int kE_kill(struct solver_data *solver) {
 
+  solver_halo_free(solver, &kE_halo);
   free(kE.k);
   free(kE.E);
   free(kE.nu_t);
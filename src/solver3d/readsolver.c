@@ -19,7 +19,17 @@
 
 /* list of one dimensional solver properties */
 const char *solver_properties_double[] = { "nu", "rho", "t", "delt", "writet", "endt", 
-                                           "autot", "abstol", "reltol", "end" };
+                                           "autot", "abstol", "reltol", "threads", 
+                                           "distributed", "output_buffers", "output_drop", 
+                                           "checkpointt", "vtk_compression", "vtk_raw", "vtk_float32", 
+                                           "pressure_pc", "pressure_matrix_free", 
+                                           "pressure_pc_reuse", "pressure_pc_reuse_iter", 
+                                           "pressure_pc_reuse_changed", "pressure_warm_start", 
+                                           "pressure_active_only", "pressure_ksp", 
+                                           "pressure_line_gs", "pressure_line_smoother", 
+                                           "pressure_pc_single", "viscous_implicit", 
+                                           "viscous_iter", "viscous_tol", "balance", 
+                                           "balance_fluid", "balance_limit", "end" };
 
 int read_solver_xml(struct solver_data *solver, char *filename) {
   xmlXPathContext *xpathCtx;
@@ -10,6 +10,7 @@
 #include <string.h>
 #include <math.h>
 #include <time.h>
+#include <mpi.h>
 
 #include "mesh.h"
 #include "readfile.h"
@@ -17,11 +18,13 @@
 #include "readsolver.h"
 #include "laminar.h"
 #include "vof_mpi.h"
+#include "solver_mpi.h"
 #include "kE.h"
 
 struct solver_data *solver_init_empty() {
 
   struct solver_data *solver;
+  int i;
 
   solver = malloc(sizeof(struct solver_data));
   if (solver == NULL) {
@@ -52,6 +55,7 @@ struct solver_data *solver_init_empty() {
                           * civil engineering problems */
 
   solver->writet = 1;
+  solver->checkpointt = 0;
 
   solver->nu   = 1.004e-6;
   solver->rho  = 1000;
@@ -61,6 +65,53 @@ struct solver_data *solver_init_empty() {
 
   solver->con = 0.45;
 
+  solver->threads = 0;
+  solver->distributed = 0;
+  solver->output_buffers = 2;
+  solver->output_drop = 0;
+  solver->vtk_compression = -1;
+  solver->vtk_raw = 0;
+  solver->vtk_float32 = 0;
+  solver->pressure_pc = pressure_pc_bjacobi;
+  solver->pressure_ksp = pressure_ksp_gmres;
+  solver->pressure_line_gs = 0;
+  solver->pressure_line_smoother = 0;
+  solver->pressure_pc_single = 0;
+  solver->pressure_matrix_free = 0;
+  solver->pressure_pc_reuse = 0;
+  solver->pressure_pc_reuse_iter = 0;
+  solver->pressure_pc_reuse_changed = 0;
+  solver->pressure_active_only = 0;
+  solver->pressure_warm_start = 0;
+  solver->pressure_time = 0;
+  solver->pressure_setup_time = 0;
+  solver->pressure_reduce_time = 0;
+  solver->pressure_active_rows = 0;
+  solver->viscous_implicit = 0;
+  solver->viscous_iter = 100;
+  solver->viscous_tol = 1e-6;
+  solver->viscous_sweeps = 0;
+  solver->comm_cart = MPI_COMM_NULL;
+  for(i=0; i < 3; i++) {
+    solver->cart_dims[i] = 1;
+    solver->cart_coords[i] = 0;
+  }
+  for(i=0; i < 6; i++) solver->neighbour[i] = MPI_PROC_NULL;
+  solver->halo.fields = 0;
+  solver->halo_velocity.fields = 0;
+  solver->halo_vof.fields = 0;
+  solver->halo_wait = 0;
+  solver->halo_hidden = 0;
+  solver->partition = NULL;
+  solver->balance = 0;
+  solver->balance_fluid = 0;
+  solver->balance_limit = 0;
+  solver->piece_start = NULL;
+  solver->piece_range = NULL;
+  for(i=0; i < timer_count; i++) solver->timer[i] = 0;
+  solver->pressure_solves = 0;
+  solver->pressure_iter_total = 0;
+
   solver->gx   = 0;
   solver->gy   = 0;
   solver->gz   = -9.81;
@@ -314,7 +365,8 @@ int solver_set_initial(struct solver_data *solver, char *param, int dims,
       return(1);
     }  
   
-    mesh_fill_vof(solver->mesh, vector);
+    if(solver->distributed) solver_mpi_fill_vof(solver, vector);
+    else mesh_fill_vof(solver->mesh, vector);
   
   } else if(strcmp(param, "velocity")==0) {
     if(dims < 3) {
@@ -486,6 +538,18 @@ int solver_set_value(struct solver_data *solver, char *param, int dims,
 
     solver->writet = vector[0];
   }
+  else if (strcmp(param, "checkpointt")==0) {
+    if(dims != 1) {
+      printf("error in source file: checkpointt requires 1 arguments\n");
+      return(1);
+    }
+    if(vector[0] < 0) {
+      printf("error in source file: checkpointt must not be negative\n");
+      return(1);
+    }
+
+    solver->checkpointt = vector[0];
+  }
   else if (strcmp(param, "delt")==0) {
     if(dims != 1) {
       printf("error in source file: delt requires 1 arguments\n");
@@ -494,6 +558,250 @@ int solver_set_value(struct solver_data *solver, char *param, int dims,
 
     solver->delt = vector[0];
   }
+  else if (strcmp(param, "threads")==0) {
+    if(dims != 1) {
+      printf("error in source file: threads requires 1 arguments\n");
+      return(1);
+    }
+    if(vector[0] < 0) {
+      printf("error in source file: threads must not be negative\n");
+      return(1);
+    }
+
+    solver->threads = (int) vector[0];
+  }
+  else if (strcmp(param, "distributed")==0) {
+    if(dims != 1) {
+      printf("error in source file: distributed requires 1 arguments\n");
+      return(1);
+    }
+
+    solver->distributed = (vector[0] > 0);
+  }
+  else if (strcmp(param, "output_buffers")==0) {
+    if(dims != 1) {
+      printf("error in source file: output_buffers requires 1 arguments\n");
+      return(1);
+    }
+    if(vector[0] < 0) {
+      printf("error in source file: output_buffers must not be negative\n");
+      return(1);
+    }
+
+    solver->output_buffers = (int) vector[0];
+  }
+  else if (strcmp(param, "output_drop")==0) {
+    if(dims != 1) {
+      printf("error in source file: output_drop requires 1 arguments\n");
+      return(1);
+    }
+
+    solver->output_drop = (vector[0] > 0);
+  }
+  else if (strcmp(param, "vtk_compression")==0) {
+    if(dims != 1) {
+      printf("error in source file: vtk_compression requires 1 arguments\n");
+      return(1);
+    }
+    if(vector[0] < -1 || vector[0] > 9) {
+      printf("error in source file: vtk_compression must be between -1 and 9\n");
+      return(1);
+    }
+
+    solver->vtk_compression = (int) vector[0];
+  }
+  else if (strcmp(param, "vtk_raw")==0) {
+    if(dims != 1) {
+      printf("error in source file: vtk_raw requires 1 arguments\n");
+      return(1);
+    }
+
+    solver->vtk_raw = (vector[0] > 0);
+  }
+  else if (strcmp(param, "vtk_float32")==0) {
+    if(dims != 1) {
+      printf("error in source file: vtk_float32 requires 1 arguments\n");
+      return(1);
+    }
+
+    solver->vtk_float32 = (vector[0] > 0);
+  }
+  else if (strcmp(param, "pressure_pc")==0) {
+    if(dims != 1) {
+      printf("error in source file: pressure_pc requires 1 arguments\n");
+      return(1);
+    }
+    if(vector[0] < 0 || vector[0] >= pressure_pc_count) {
+      printf("error in source file: pressure_pc must be 0 (block jacobi), 1 (multigrid) or 2 (vertical lines)\n");
+      return(1);
+    }
+
+    solver->pressure_pc = (int) vector[0];
+  }
+  else if (strcmp(param, "pressure_line_gs")==0) {
+    if(dims != 1) {
+      printf("error in source file: pressure_line_gs requires 1 arguments\n");
+      return(1);
+    }
+
+    solver->pressure_line_gs = (vector[0] > 0);
+  }
+  else if (strcmp(param, "pressure_line_smoother")==0) {
+    if(dims != 1) {
+      printf("error in source file: pressure_line_smoother requires 1 arguments\n");
+      return(1);
+    }
+
+    solver->pressure_line_smoother = (vector[0] > 0);
+  }
+  else if (strcmp(param, "pressure_pc_single")==0) {
+    if(dims != 1) {
+      printf("error in source file: pressure_pc_single requires 1 arguments\n");
+      return(1);
+    }
+
+    solver->pressure_pc_single = (vector[0] > 0);
+  }
+  else if (strcmp(param, "balance")==0) {
+    if(dims != 1) {
+      printf("error in source file: balance requires 1 arguments\n");
+      return(1);
+    }
+
+    solver->balance = (vector[0] > 0);
+  }
+  else if (strcmp(param, "balance_fluid")==0) {
+    if(dims != 1) {
+      printf("error in source file: balance_fluid requires 1 arguments\n");
+      return(1);
+    }
+    if(vector[0] < 0) {
+      printf("error in source file: balance_fluid must not be negative\n");
+      return(1);
+    }
+
+    solver->balance_fluid = vector[0];
+  }
+  else if (strcmp(param, "balance_limit")==0) {
+    if(dims != 1) {
+      printf("error in source file: balance_limit requires 1 arguments\n");
+      return(1);
+    }
+    if(vector[0] != 0 && vector[0] <= 1) {
+      printf("error in source file: balance_limit must be 0 or more than 1\n");
+      return(1);
+    }
+
+    solver->balance_limit = vector[0];
+  }
+  else if (strcmp(param, "viscous_implicit")==0) {
+    if(dims != 1) {
+      printf("error in source file: viscous_implicit requires 1 arguments\n");
+      return(1);
+    }
+
+    solver->viscous_implicit = (vector[0] > 0);
+  }
+  else if (strcmp(param, "viscous_iter")==0) {
+    if(dims != 1) {
+      printf("error in source file: viscous_iter requires 1 arguments\n");
+      return(1);
+    }
+    if(vector[0] < 1) {
+      printf("error in source file: viscous_iter must be at least 1\n");
+      return(1);
+    }
+
+    solver->viscous_iter = (int) vector[0];
+  }
+  else if (strcmp(param, "viscous_tol")==0) {
+    if(dims != 1) {
+      printf("error in source file: viscous_tol requires 1 arguments\n");
+      return(1);
+    }
+    if(vector[0] <= 0) {
+      printf("error in source file: viscous_tol must be positive\n");
+      return(1);
+    }
+
+    solver->viscous_tol = vector[0];
+  }
+  else if (strcmp(param, "pressure_ksp")==0) {
+    if(dims != 1) {
+      printf("error in source file: pressure_ksp requires 1 arguments\n");
+      return(1);
+    }
+    if(vector[0] < 0 || vector[0] >= pressure_ksp_count) {
+      printf("error in source file: pressure_ksp must be 0 (gmres), 1 (pipelined gmres), 2 (pipelined cg) or 3 (gropp cg)\n");
+      return(1);
+    }
+
+    solver->pressure_ksp = (int) vector[0];
+  }
+  else if (strcmp(param, "pressure_matrix_free")==0) {
+    if(dims != 1) {
+      printf("error in source file: pressure_matrix_free requires 1 arguments\n");
+      return(1);
+    }
+
+    solver->pressure_matrix_free = (vector[0] > 0);
+  }
+  else if (strcmp(param, "pressure_pc_reuse")==0) {
+    if(dims != 1) {
+      printf("error in source file: pressure_pc_reuse requires 1 arguments\n");
+      return(1);
+    }
+    if(vector[0] < 0) {
+      printf("error in source file: pressure_pc_reuse must not be negative\n");
+      return(1);
+    }
+
+    solver->pressure_pc_reuse = (int) vector[0];
+  }
+  else if (strcmp(param, "pressure_pc_reuse_iter")==0) {
+    if(dims != 1) {
+      printf("error in source file: pressure_pc_reuse_iter requires 1 arguments\n");
+      return(1);
+    }
+    if(vector[0] < 0) {
+      printf("error in source file: pressure_pc_reuse_iter must not be negative\n");
+      return(1);
+    }
+
+    solver->pressure_pc_reuse_iter = (int) vector[0];
+  }
+  else if (strcmp(param, "pressure_pc_reuse_changed")==0) {
+    if(dims != 1) {
+      printf("error in source file: pressure_pc_reuse_changed requires 1 arguments\n");
+      return(1);
+    }
+    if(vector[0] < 0) {
+      printf("error in source file: pressure_pc_reuse_changed must not be negative\n");
+      return(1);
+    }
+
+    solver->pressure_pc_reuse_changed = vector[0];
+  }
+  else if (strcmp(param, "pressure_active_only")==0) {
+    if(dims != 1) {
+      printf("error in source file: pressure_active_only requires 1 arguments\n");
+      return(1);
+    }
+
+    solver->pressure_active_only = (vector[0] > 0);
+  }
+  else if (strcmp(param, "pressure_warm_start")==0) {
+    if(dims != 1) {
+      printf("error in source file: pressure_warm_start requires 1 arguments\n");
+      return(1);
+    }
+    if(vector[0] < 0 || vector[0] > 2) {
+      printf("error in source file: pressure_warm_start must be 0 (off), 1 (last correction) or 2 (extrapolated)\n");
+      return(1);
+    }
+
+    solver->pressure_warm_start = (int) vector[0];
+  }
   else if (strcmp(param, "autot")==0) {
     if(dims != 1) {
       printf("error in source file: autot requires 1 arguments\n");
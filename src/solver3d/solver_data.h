@@ -25,6 +25,37 @@ struct ic_data {
    double value[3];
 };
 
+/* preconditioners for the pressure solve */
+enum pressure_preconditioners { pressure_pc_bjacobi, pressure_pc_gamg, pressure_pc_line, pressure_pc_count };
+
+/* krylov methods for the pressure solve.  the pipelined and low
+ * synchronization ones overlap or merge the global reductions, the cg
+ * variants solve a symmetric form of the system */
+enum pressure_krylov_methods { pressure_ksp_gmres, pressure_ksp_pgmres, pressure_ksp_pipecg,
+                               pressure_ksp_groppcg, pressure_ksp_count };
+
+/* wall time accumulated by each part of the timestep loop */
+enum solver_timers { timer_velocity, timer_pressure, timer_boundaries, timer_turbulence,
+                     timer_convect, timer_nvof, timer_deltcal, timer_halo, timer_write,
+                     timer_count };
+
+/* reductions of the scalars registered with solver_reduce_add */
+enum solver_reduce_ops { reduce_sum, reduce_max, reduce_min, reduce_op_count };
+
+/* a halo exchange of several fields, their edge planes packed into one
+ * message per neighbour.  solver_halo_init sets up persistent requests
+ * once, then solver_halo_begin starts and solver_halo_end finishes it */
+#define SOLVER_HALO_FIELDS 4
+struct solver_halo {
+  int fields;    /* fields exchanged, 0 before solver_halo_init */
+  double *data[SOLVER_HALO_FIELDS];
+  long int irange; /* IRANGE the requests were set up for */
+  double *buffer;  /* packed planes received from west and east, then sent to them */
+  MPI_Request requests[4];
+  int active;    /* started and not yet finished */
+  double posted; /* MPI_Wtime it was started */
+};
+
 struct solver_data {
 
   struct ic_data ic[16]; /* describe up to 16 initial conditions */
@@ -34,6 +65,19 @@ struct solver_data {
   int size;
   MPI_Comm comm_upstream;
   MPI_Comm comm_downstream;
+  MPI_Comm comm_cart; /* cartesian topology of the pieces */
+  int cart_dims[3]; /* pieces along i, j and k */
+  int cart_coords[3]; /* position of this piece */
+  int neighbour[6]; /* ranks across the faces numbered as in mesh->wb, MPI_PROC_NULL on a wall */
+  struct solver_halo halo; /* u, v, w and P, which the kernels finish before their edge planes */
+  struct solver_halo halo_velocity; /* u, v and w */
+  struct solver_halo halo_vof; /* vof */
+  double halo_wait; /* seconds spent waiting for halo exchanges */
+  double halo_hidden; /* seconds halo exchanges spent in flight behind computation */
+  long int *partition; /* first plane owned by each piece along i, then IMAX */
+  int balance; /* place the pieces by the open cells of each plane rather than evenly */
+  double balance_fluid; /* extra weight of an open cell holding fluid */
+  double balance_limit; /* imbalance at a write that stops the run to restart balanced, 0 for none */
 
   double emf; 
   double emf_c;
@@ -46,6 +90,7 @@ struct solver_data {
   double delt, delt_n, delt_min; /* timestep */
   double endt; /* solution completion criteria */
   double writet;
+  double checkpointt; /* interval between binary checkpoints, 0 for none */
 
   long int iter;
   long int niter;
@@ -67,6 +112,36 @@ struct solver_data {
 
   double abstol; /* pressure iteration convergence criteria */
   double reltol;
+  int pressure_pc; /* one of pressure_preconditioners */
+  int pressure_ksp; /* one of pressure_krylov_methods */
+  int pressure_line_gs; /* vertical lines relaxed by symmetric gauss-seidel along j instead of jacobi */
+  int pressure_line_smoother; /* apply the vertical lines before and after the block jacobi or multigrid */
+  int pressure_pc_single; /* the relaxations of the preconditioner use float coefficients */
+  int pressure_matrix_free; /* apply the pressure operator from the mesh arrays instead of assembling it */
+  int pressure_pc_reuse; /* steps the preconditioner may be kept for, 0 rebuilds it every step */
+  int pressure_pc_reuse_iter; /* rebuild it once a solve takes more iterations, 0 for no limit */
+  double pressure_pc_reuse_changed; /* rebuild it once this share of cells changed N_VOF, 0 for no limit */
+  int pressure_active_only; /* solve over the cells with an unknown correction, leaving out solid and empty ones */
+  int pressure_warm_start; /* corrections kept to seed the next solve, 2 extrapolates them in time */
+  double pressure_time; /* seconds spent assembling, setting up and solving the last pressure system */
+  double pressure_setup_time; /* of which setting up the preconditioner */
+  double pressure_reduce_time; /* of which waiting in the global reductions of the krylov solver */
+  long int pressure_active_rows; /* rows this rank holds in the reduced pressure system, 0 when every cell is solved */
+  int viscous_implicit; /* solve the viscous term of the predictor implicitly, lifting the viscous timestep limit */
+  int viscous_iter; /* most relaxation sweeps of each implicit viscous solve */
+  double viscous_tol; /* velocity change of a sweep the implicit viscous solve stops at */
+  int viscous_sweeps; /* sweeps the last implicit viscous step took */
+
+  int threads; /* OpenMP threads per rank, 1 runs the serial loops, 0 picks automatically */
+  int distributed; /* every rank loads and writes its own slab, rank 0 no longer holds the whole mesh */
+  int output_buffers; /* snapshots the background writer may hold, 0 writes in the timestep loop */
+  int output_drop; /* skip an output when every buffer is still queued, instead of waiting */
+  int vtk_compression; /* zlib level of the .vti files, -1 for the zlib default, 0 uncompressed */
+  int vtk_raw; /* raw binary appended data in the .vti files instead of base64 */
+  int vtk_float32; /* P, U, vorticity, k and E are written as Float32 */
+  long int *piece_start, *piece_range; /* slab written by each rank, kept on rank 0 for the .pvti masters */
+  double timer[timer_count]; /* seconds spent in each kernel on this rank */
+  long int pressure_solves, pressure_iter_total; /* for the mean iterations per pressure solve */
 
   int conv_reason;
   char conv_reason_str[256];
@@ -11,6 +11,7 @@
 #include <time.h>
 #include <petscksp.h>
 #include <mpi.h>
+#include <omp.h>
 
 #include "mesh.h"
 #include "readfile.h"
@@ -24,29 +25,216 @@
 #include "vof_mpi.h"
 #include "csv.h"
 #include "track.h"
+#include "checkpoint.h"
+
+/* planes of piece p, including its halo planes.  the piece owns
+ * partition[p] up to partition[p + 1] */
+static void solver_mpi_extent(struct solver_data *solver, int p, long int *start, long int *range) {
+  const int size = solver->cart_dims[0];
+  long int end;
+
+  *start = solver->partition[p];
+  end = solver->partition[p + 1];
+  if(p > 0) (*start)--;
+  if(p < size - 1) end++;
+  *range = end - *start;
+}
 
 int solver_mpi_range(struct solver_data *solver) {
-  long int range, start;
-  int size, rank;
+  long int range, start, planes;
+  int size, rank, p;
+
+  /* pieces are numbered along i by their coordinate in the topology */
+  rank = solver->cart_coords[0];
+  size = solver->cart_dims[0];
+
+  /* without a balanced partition every piece gets the same planes */
+  if(solver->partition == NULL) {
+    solver->partition = malloc(sizeof(long int) * (size + 1));
+    if(solver->partition == NULL) {
+      printf("error: could not allocate the partition\n");
+      return 1;
+    }
+    range = (IMAX + (size - 1)) / size;
+    for(p=0; p < size; p++) solver->partition[p] = min(range * p, IMAX);
+    solver->partition[size] = IMAX;
+  }
 
-  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-  MPI_Comm_size(MPI_COMM_WORLD, &size);
-  
-  range = (IMAX + (size - 1)) / size;
-  start = range * rank;
-  start -= 1;
-  start = max(start, 0);
-  range += 2;
-  if(start + range > IMAX) range = IMAX - start;
-  if(!rank) range--;
+  /* every piece needs a plane of its own besides the ghost plane of a wall */
+  planes = IMAX;
+  for(p=0; p < size; p++) planes = min(planes, solver->partition[p + 1] - solver->partition[p]);
+  if(planes < 2) {
+    if(!solver->rank)
+      printf("error: %d pieces along i leave one without a plane of the %ld in the mesh\n", size, IMAX);
+    return 1;
+  }
+
+  solver_mpi_extent(solver, rank, &start, &range);
   solver->mesh->i_range = range;
   solver->mesh->i_start = start;
 
   return 0;
 }
 
+/* weight of local plane i: its open cells, and balance_fluid more for
+ * each holding fluid */
+static double solver_mpi_plane_weight(struct solver_data *solver, long int i) {
+  long int j, k;
+  double weight = 0;
+
+  for(j=0; j<JMAX; j++) {
+    for(k=0; k<KMAX; k++) {
+      if(FV(i,j,k) <= 0) continue;
+      weight += 1;
+      if(VOF(i,j,k) > 0) weight += solver->balance_fluid;
+    }
+  }
+
+  return weight;
+}
+
+/* places the piece boundaries so that each piece holds the same share of
+ * the plane weights.  rank 0 holds the whole mesh at this point, with the
+ * values of a restart, so a restart balances again for the fluid it starts
+ * from.  a distributed run has no rank holding the whole mesh before the
+ * slabs are allocated, and keeps the even split */
+int solver_mpi_balance(struct solver_data *solver) {
+  const int size = solver->cart_dims[0];
+  double *weight, total, sum, target;
+  long int i;
+  int p;
+
+  if(!solver->balance || size == 1) return 0;
+  if(solver->distributed) {
+    if(!solver->rank) printf("warning: a distributed run keeps the even partition, balance is ignored\n");
+    return 0;
+  }
+
+  if(solver->partition == NULL) solver->partition = malloc(sizeof(long int) * (size + 1));
+  if(solver->partition == NULL) {
+    printf("error: could not allocate the partition\n");
+    return 1;
+  }
+
+  if(!solver->rank) {
+    weight = malloc(sizeof(double) * IMAX);
+    if(weight == NULL) {
+      printf("error: could not allocate the partition weights\n");
+      return 1;
+    }
+
+    total = 0;
+    for(i=0; i<IMAX; i++) {
+      weight[i] = solver_mpi_plane_weight(solver, i);
+      total += weight[i];
+    }
+    if(total <= 0) {
+      for(i=0; i<IMAX; i++) weight[i] = 1;
+      total = IMAX;
+    }
+
+    /* each boundary goes at the first plane the running sum reaches its
+     * share at, leaving at least 2 planes to every piece */
+    solver->partition[0] = 0;
+    sum = 0;
+    i = 0;
+    for(p=1; p < size; p++) {
+      target = total * p / size;
+      while(i < IMAX && sum + weight[i] <= target) sum += weight[i++];
+      i = max(i, solver->partition[p - 1] + 2);
+      i = min(i, IMAX - 2 * (size - p));
+      solver->partition[p] = i;
+      sum = 0;
+      for(i=0; i < solver->partition[p]; i++) sum += weight[i];
+    }
+    solver->partition[size] = IMAX;
+
+    free(weight);
+  }
+
+  MPI_Bcast(solver->partition, size + 1, MPI_LONG, 0, MPI_COMM_WORLD);
+
+  return 0;
+}
+
+/* prints the work held by each piece and returns the largest over the
+ * mean, with the per-piece lines on the first call only */
+double solver_mpi_balance_report(struct solver_data *solver) {
+  static int reported = 0;
+  const int busy[] = { timer_velocity, timer_pressure, timer_boundaries, timer_turbulence,
+                       timer_convect, timer_nvof, timer_deltcal };
+  double work[2], *all = NULL, cells_max, cells_mean, time_max, time_mean;
+  long int i, first, last, planes;
+  int p, n;
+
+  if(solver->size == 1) return 1;
+
+  first = solver_mpi_wall(solver, 0) ? 0 : 1;
+  last = solver_mpi_wall(solver, 1) ? IRANGE - 1 : IRANGE - 2;
+
+  work[0] = 0;
+  for(i=first; i <= last; i++) work[0] += solver_mpi_plane_weight(solver, i);
+  work[1] = 0;
+  for(n=0; n < (int) (sizeof(busy) / sizeof(busy[0])); n++) work[1] += solver->timer[busy[n]];
+
+  if(!solver->rank) {
+    all = malloc(sizeof(double) * 2 * solver->size);
+    if(all == NULL) printf("error: could not allocate the balance report\n");
+  }
+  MPI_Gather(work, 2, MPI_DOUBLE, all, 2, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+  cells_max = solver_mpi_max(solver, work[0]);
+  cells_mean = solver_mpi_sum(solver, work[0]) / solver->size;
+
+  if(!solver->rank && all != NULL) {
+    time_max = time_mean = 0;
+    for(p=0; p < solver->size; p++) {
+      time_max = max(time_max, all[2*p+1]);
+      time_mean += all[2*p+1] / solver->size;
+    }
+
+    if(!reported) {
+      printf("Partition along i:\n");
+      planes = IMAX;
+      for(p=0; p < solver->size; p++) {
+        printf("  rank %3d: planes %ld to %ld, %.0lf cells\n", p, solver->partition[p],
+               solver->partition[p + 1] - 1, all[2*p]);
+        planes = min(planes, solver->partition[p + 1] - solver->partition[p]);
+      }
+      if(planes < 8)
+        printf("warning: a piece owns %ld planes and exchanges 2 halo planes, fewer ranks with more threads each would communicate less\n", planes);
+    }
+    printf("Load imbalance (largest over mean): %.2lf in cells", cells_mean > 0 ? cells_max / cells_mean : 1);
+    if(time_mean > 0) printf(", %.2lf in kernel time", time_max / time_mean);
+    printf("\n\n");
+    free(all);
+  }
+  reported = 1;
+
+  return cells_mean > 0 ? cells_max / cells_mean : 1;
+}
+
+/* whether face of this piece, numbered as the walls in mesh->wb, lies on
+ * the boundary of the mesh rather than against another piece */
+int solver_mpi_wall(struct solver_data *solver, int face) {
+  return solver->neighbour[face] == MPI_PROC_NULL;
+}
+
 int solver_mpi_init_comm(struct solver_data *solver) {
-  int colour;
+  const int periods[3] = { 0, 0, 0 };
+  int colour, axis;
+
+  /* every kernel loops over the whole of j and k, so the pieces are slabs
+   * along i.  the exchanges and boundaries take the neighbours and walls
+   * of a piece from the topology rather than from its rank.  the ranks
+   * are kept as they are, the pieces being numbered by rank */
+  solver->cart_dims[0] = solver->size;
+  solver->cart_dims[1] = 1;
+  solver->cart_dims[2] = 1;
+  MPI_Cart_create(MPI_COMM_WORLD, 3, solver->cart_dims, periods, 0, &solver->comm_cart);
+  MPI_Cart_coords(solver->comm_cart, solver->rank, 3, solver->cart_coords);
+  for(axis=0; axis < 3; axis++)
+    MPI_Cart_shift(solver->comm_cart, axis, 1, &solver->neighbour[2*axis], &solver->neighbour[2*axis+1]);
   
   if(solver->rank % 2 == 0) { /* even rank */
     colour = solver->rank;
@@ -104,33 +292,64 @@ int solver_mpi(struct solver_data *solver, double timestep, double delt)
   if(solver_load(solver, "solver.xml")==1)
     return 1;
 
-  solver_mpi_range(solver);
+  /* without neighbours to share the cores with, a lone process takes them all */
+  if(solver->threads < 1)
+    solver->threads = (size == 1) ? omp_get_max_threads() : 1;
+
+  if(solver_mpi_range(solver))
+    return 1;
+  if(solver->distributed) solver_mpi_piece(solver);
   if(solver_mpi_init_complete(solver)==1)
     return 1;
 
   if(solver->turbulence_read != NULL) solver->turbulence_read("solver.xml");
   
-  solver->init(solver);
   solver->turbulence_init(solver);
   
-  if(mesh_load_csv(solver->mesh, 0) == 1) return 1;
-  solver_initial_values(solver);
-  solver->nvof(solver);
+  if(!solver->distributed) {
+    if(mesh_load_csv(solver->mesh, 0) == 1) return 1;
+    solver_initial_values(solver);
+    solver->nvof(solver);
+  }
 
   if(timestep > solver->emf) {
     solver->t = timestep;
-    csv_read_U_p_vof(solver->mesh, timestep);
-    solver->turbulence_load_values(solver);
+    if(!solver->distributed && checkpoint_read(solver, timestep)) {
+      solver->t = timestep;
+      csv_read_U_p_vof(solver->mesh, timestep);
+      solver->turbulence_load_values(solver);
+    }
   }
   
   if (delt > solver->emf) solver->delt = delt;
   
   solver_broadcast_all(solver);
   mesh_broadcast_all(solver->mesh);
+
+  /* rank 0 still holds the whole mesh, so only its extent changes */
+  if(solver_mpi_balance(solver))
+    return 1;
+  if(solver_mpi_range(solver))
+    return 1;
+
+  /* the copy of the previous timestep takes the extent settled above */
+  if(solver->init(solver))
+    return 1;
   
   if(kE_check(solver)) kE_broadcast(solver);
   
-  solver_send_all(solver);
+  if(solver->distributed) {
+    if(solver_mpi_load(solver, timestep) == 1) return 1;
+    /* a delt given on the command line still overrides the checkpoint */
+    if(delt > solver->emf) solver->delt = delt;
+    MPI_Bcast(&solver->delt, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  }
+  else {
+    solver_send_all(solver);
+    solver_mpi_piece(solver);
+  }
+  if(solver_mpi_piece_extents(solver) == 1) return 1;
+  solver_mpi_balance_report(solver);
   if(timestep < solver->emf) solver->write(solver);
   track_read();
   
@@ -157,7 +376,11 @@ int solver_mpi_high_rank(struct solver_data *solver, double timestep) {
   
   solver_broadcast_all(solver);
   mesh_broadcast_all(solver->mesh);
-  solver_mpi_range(solver);
+  if(solver_mpi_balance(solver))
+    return 1;
+  if(solver_mpi_range(solver))
+    return 1;
+  if(solver->distributed) solver_mpi_piece(solver);
   
   if(solver_check(solver) == 1) {
     return(1);
@@ -172,7 +395,16 @@ int solver_mpi_high_rank(struct solver_data *solver, double timestep) {
   solver->init(solver);
   solver->turbulence_init(solver);
   
-  solver_recv_all(solver);
+  if(solver->distributed) {
+    if(solver_mpi_load(solver, timestep) == 1) return 1;
+    MPI_Bcast(&solver->delt, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  }
+  else {
+    solver_recv_all(solver);
+    solver_mpi_piece(solver);
+  }
+  if(solver_mpi_piece_extents(solver) == 1) return 1;
+  solver_mpi_balance_report(solver);
   if(timestep < solver->emf) solver->write(solver);
   
   if(solver_run(solver)==1)
@@ -181,6 +413,106 @@ int solver_mpi_high_rank(struct solver_data *solver, double timestep) {
   return(0);
 }
 
+/* with more than one rank, each rank writes the output for its own slab.
+ * a distributed run sets this up before loading, as rank 0 never holds the
+ * whole mesh, otherwise once rank 0 has sent the slabs out */
+int solver_mpi_piece(struct solver_data *solver) {
+  if(solver->size == 1) return 0;
+
+  solver->mesh->piece = solver->rank;
+  solver->mesh->pieces = solver->size;
+
+  return 0;
+}
+
+/* rank 0 collects where every piece lies to write the .pvti masters */
+int solver_mpi_piece_extents(struct solver_data *solver) {
+  if(solver->size == 1) return 0;
+
+  if(!solver->rank && solver->piece_start == NULL) {
+    solver->piece_start = malloc(sizeof(long int) * solver->size);
+    solver->piece_range = malloc(sizeof(long int) * solver->size);
+    if(solver->piece_start == NULL || solver->piece_range == NULL) {
+      printf("error: could not allocate piece extents\n");
+      return 1;
+    }
+  }
+
+  MPI_Gather(&solver->mesh->i_start, 1, MPI_LONG, solver->piece_start, 1, MPI_LONG, 0, MPI_COMM_WORLD);
+  MPI_Gather(&solver->mesh->i_range, 1, MPI_LONG, solver->piece_range, 1, MPI_LONG, 0, MPI_COMM_WORLD);
+
+  return 0;
+}
+
+/* in a distributed run every rank reads its own slab of the case files
+ * and sets its own initial values, instead of receiving them from rank 0 */
+int solver_mpi_load(struct solver_data *solver, double timestep) {
+  double failed = 0;
+
+  if(mesh_load_csv(solver->mesh, 0) == 1) failed = 1;
+  if(solver_mpi_max(solver, failed) > 0) return 1;
+
+  solver_initial_values(solver);
+  solver->nvof(solver);
+
+  /* every rank restarts from the checkpoint, or all fall back to the csv */
+  if(timestep > solver->emf) {
+    if(solver_mpi_max(solver, checkpoint_read(solver, timestep)) > 0) {
+      solver->t = timestep;
+      csv_read_U_p_vof(solver->mesh, timestep);
+      solver->turbulence_load_values(solver);
+    }
+  }
+
+  return 0;
+}
+
+/* flood fill of the initial fluid volume across a distributed mesh.  each
+ * rank fills its slab, then wet halo planes seed the fill on the neighbour
+ * until no rank finds another cell to fill */
+int solver_mpi_fill_vof(struct solver_data *solver, double *vector) {
+  double seed[3], filled;
+  long int i, j, k, halo, inner;
+  int side;
+
+  mesh_fill_vof(solver->mesh, vector);
+
+  do {
+    filled = 0;
+    solver_sendrecv_edge(solver, solver->mesh->vof);
+
+    for(side = 0; side < 2; side++) {
+      if(side == 0 && ISTART > 0) {
+        halo = 0;
+        inner = 1;
+      }
+      else if(side == 1 && ISTART + IRANGE < IMAX) {
+        halo = IRANGE - 1;
+        inner = IRANGE - 2;
+      }
+      else continue;
+
+      for(j = 0; j < JMAX; j++) {
+        for(k = 0; k < KMAX; k++) {
+          if(VOF(halo,j,k) < 1.0 || FV(halo,j,k) <= 0.0) continue;
+          if(VOF(inner,j,k) >= 1.0 || FV(inner,j,k) <= 0.0) continue;
+
+          i = inner + ISTART;
+          seed[0] = solver->mesh->origin[0] + (i + 0.5) * DELX;
+          seed[1] = solver->mesh->origin[1] + (j + 0.5) * DELY;
+          seed[2] = solver->mesh->origin[2] + (k + 0.5) * DELZ;
+          mesh_fill_vof(solver->mesh, seed);
+          filled++;
+        }
+      }
+    }
+
+    filled = solver_mpi_sum(solver, filled);
+  } while(filled > 0);
+
+  return 0;
+}
+
 int solver_mpi_init_complete(struct solver_data *solver) {
 
   if(solver_check(solver) == 1) {
@@ -222,41 +554,143 @@ int solver_recv_all(struct solver_data *solver) {
 }
 
 int solver_sendrecv_edge(struct solver_data *solver, double *data) {
-  /* each process will communicate its eastern edge with the next process' western edge */
-  int rank;
-  int size;
+  /* each piece swaps its edge planes with the pieces across its west and
+   * east faces.  a face on a wall has no neighbour, which leaves its ghost
+   * plane to the boundaries.  fields exchanged every timestep go through a
+   * struct solver_halo instead */
   MPI_Request requests[4];
+  double t_wait;
 
-  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  if(solver->size == 1) return 0;
 
-  if(!rank) {
-    solver_mpi_sendrecv(solver, rank + 1, data, IRANGE-2, 1,
-                                rank + 1, data, IRANGE-1, 1);
-  } else if(rank + 1 < size) {  
-    /* internal cases */
-    solver_mpi_isend(solver, data, rank-1, 1, 1, &requests[0]);
-    solver_mpi_isend(solver, data, rank+1, IRANGE-2, 1, &requests[1]);
-    solver_mpi_irecv(solver, data, rank-1, 0, 1, &requests[2]);
-    solver_mpi_irecv(solver, data, rank+1, IRANGE-1, 1, &requests[3]);
-    MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
-
-    /* solver_mpi_sendrecv(solver, rank - 1, data, 1, 1, 
-                                rank - 1, data, 0, 1);
-    solver_mpi_sendrecv(solver, rank + 1, data, IRANGE-2, 1,
-                                rank + 1, data, IRANGE-1, 1); */
-   } else {
-    solver_mpi_sendrecv(solver, rank - 1, data, 1, 1, 
-                                rank - 1, data, 0, 1);
-   }
-  
-   return 0;
+  t_wait = MPI_Wtime();
+  solver_mpi_irecv(solver, data, solver->neighbour[0], 0, 1, &requests[0]);
+  solver_mpi_irecv(solver, data, solver->neighbour[1], IRANGE-1, 1, &requests[1]);
+  solver_mpi_isend(solver, data, solver->neighbour[0], 1, 1, &requests[2]);
+  solver_mpi_isend(solver, data, solver->neighbour[1], IRANGE-2, 1, &requests[3]);
+  MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
+  solver->halo_wait += MPI_Wtime() - t_wait;
+  
+  return 0;
+}
+
+/* sets up the exchange of the edge planes of fields arrays, which must
+ * stay in place while it is used.  tag tells the exchanges apart */
+int solver_halo_init(struct solver_data *solver, struct solver_halo *halo, int tag, int fields, double **data) {
+  const long int plane = JMAX * KMAX;
+  const int count = (int) (fields * plane);
+  double *buffer;
+  int f;
+
+  if(fields < 1 || fields > SOLVER_HALO_FIELDS) {
+    printf("error: a halo exchange takes 1 to %d fields\n", SOLVER_HALO_FIELDS);
+    return 1;
+  }
+
+  halo->fields = fields;
+  for(f=0; f < fields; f++) halo->data[f] = data[f];
+  halo->irange = IRANGE;
+  halo->buffer = NULL;
+  halo->active = 0;
+
+  if(solver->size == 1) return 0;
+
+  buffer = malloc(sizeof(double) * 4 * fields * plane);
+  if(buffer == NULL) {
+    printf("error: could not allocate a halo exchange of %d fields\n", fields);
+    halo->fields = 0;
+    return 1;
+  }
+  halo->buffer = buffer;
+
+  MPI_Recv_init(buffer, count, MPI_DOUBLE, solver->neighbour[0], tag, solver->comm_cart, &halo->requests[0]);
+  MPI_Recv_init(buffer + count, count, MPI_DOUBLE, solver->neighbour[1], tag, solver->comm_cart, &halo->requests[1]);
+  MPI_Send_init(buffer + 2 * count, count, MPI_DOUBLE, solver->neighbour[0], tag, solver->comm_cart, &halo->requests[2]);
+  MPI_Send_init(buffer + 3 * count, count, MPI_DOUBLE, solver->neighbour[1], tag, solver->comm_cart, &halo->requests[3]);
+
+  return 0;
+}
+
+/* packs the edge planes and starts the exchange.  until solver_halo_end
+ * the halo planes 0 and IRANGE-1 of the fields must not be read or written */
+int solver_halo_begin(struct solver_data *solver, struct solver_halo *halo) {
+  const long int plane = JMAX * KMAX;
+  double *send = halo->buffer + 2 * halo->fields * plane;
+  int f;
+
+  if(solver->size == 1 || halo->active) return 0;
+
+  if(halo->fields == 0 || halo->irange != IRANGE) {
+    printf("error: halo exchange not set up for the planes of this rank\n");
+    return 1;
+  }
+
+  for(f=0; f < halo->fields; f++) {
+    memcpy(send + f * plane, &halo->data[f][mesh_index(solver->mesh,1,0,0)], sizeof(double) * plane);
+    memcpy(send + (halo->fields + f) * plane, &halo->data[f][mesh_index(solver->mesh,IRANGE-2,0,0)],
+           sizeof(double) * plane);
+  }
+
+  halo->posted = MPI_Wtime();
+  MPI_Startall(4, halo->requests);
+  halo->active = 1;
+
+  return 0;
+}
+
+/* waits for the exchange and unpacks the halo planes.  the time since it
+ * was started counts as hidden behind computation, the wait as exposed */
+int solver_halo_end(struct solver_data *solver, struct solver_halo *halo) {
+  const long int plane = JMAX * KMAX;
+  const double *recv = halo->buffer;
+  double t_wait;
+  int f;
+
+  if(!halo->active) return 0;
+
+  t_wait = MPI_Wtime();
+  MPI_Waitall(4, halo->requests, MPI_STATUSES_IGNORE);
+  solver->halo_hidden += t_wait - halo->posted;
+  solver->halo_wait += MPI_Wtime() - t_wait;
+  halo->active = 0;
+
+  for(f=0; f < halo->fields; f++) {
+    if(solver->neighbour[0] != MPI_PROC_NULL)
+      memcpy(&halo->data[f][mesh_index(solver->mesh,0,0,0)], recv + f * plane, sizeof(double) * plane);
+    if(solver->neighbour[1] != MPI_PROC_NULL)
+      memcpy(&halo->data[f][mesh_index(solver->mesh,IRANGE-1,0,0)], recv + (halo->fields + f) * plane,
+             sizeof(double) * plane);
+  }
+  
+  return 0;
+}
+
+int solver_halo_exchange(struct solver_data *solver, struct solver_halo *halo) {
+  if(solver_halo_begin(solver, halo)) return 1;
+
+  return solver_halo_end(solver, halo);
+}
+
+void solver_halo_free(struct solver_data *solver, struct solver_halo *halo) {
+  int n;
+
+  if(halo->fields == 0) return;
+
+  if(solver->size > 1) {
+    solver_halo_end(solver, halo);
+    for(n=0; n < 4; n++) MPI_Request_free(&halo->requests[n]);
+  }
+  free(halo->buffer);
+  halo->buffer = NULL;
+  halo->fields = 0;
 }
 
 int solver_sendrecv_delu(struct solver_data *solver) {
   double *ds = solver->mesh->delu_downstream;
   double *us = solver->mesh->delu_upstream;
 
+  if(solver->size == 1) return 0;
+
   if(!solver->rank) {
     solver_mpi_sendrecv_replace(solver, ds, 0, 1, 1, 1);
   } else if(solver->rank + 1 < solver->size) {
@@ -276,34 +710,16 @@ int solver_sendrecv_delu(struct solver_data *solver) {
 }
 
 int solver_sendrecv_edge_int(struct solver_data *solver, int *data) {
-  /* each process will communicate its eastern edge with the next process' western edge */
-  /* TODO: instead of sendrecv, do series of non-blocking sends followed by receives for faster execution */
-  int rank;
-  int size;
+  /* as solver_sendrecv_edge */
   MPI_Request requests[4];
 
-  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  if(solver->size == 1) return 0;
 
-  if(!rank) {
-    solver_mpi_sendrecv_int(solver, rank + 1, data, IRANGE-2, 1,
-                                 rank + 1, data, IRANGE-1, 1);
-  } else if(rank + 1 < size) {  
-    /* internal cases */
-    solver_mpi_isend_int(solver, data, rank-1, 1, 1, &requests[0]);
-    solver_mpi_isend_int(solver, data, rank+1, IRANGE-2, 1, &requests[1]);
-    solver_mpi_irecv_int(solver, data, rank-1, 0, 1, &requests[2]);
-    solver_mpi_irecv_int(solver, data, rank+1, IRANGE-1, 1, &requests[3]);
-    MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
-    /* internal cases *
-    solver_mpi_sendrecv_int(solver, rank - 1, data, 1, 1, 
-                                rank - 1, data, 0, 1);
-    solver_mpi_sendrecv_int(solver, rank + 1, data, IRANGE-2, 1,
-                                rank + 1, data, IRANGE-1, 1); */
-   } else {
-    solver_mpi_sendrecv_int(solver, rank - 1, data, 1, 1, 
-                                    rank - 1, data, 0, 1);
-   }
+  solver_mpi_irecv_int(solver, data, solver->neighbour[0], 0, 1, &requests[0]);
+  solver_mpi_irecv_int(solver, data, solver->neighbour[1], IRANGE-1, 1, &requests[1]);
+  solver_mpi_isend_int(solver, data, solver->neighbour[0], 1, 1, &requests[2]);
+  solver_mpi_isend_int(solver, data, solver->neighbour[1], IRANGE-2, 1, &requests[3]);
+  MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
 
   return 0; 
 }
@@ -320,6 +736,8 @@ int solver_mpi_gather_int(struct solver_data *solver, int *data) {
   range *= JMAX;
   range *= KMAX;
 
+  if(solver->size == 1) return 0; /* rank 0 already holds the whole mesh */
+
   if (!initialized) {
     cnts = malloc(solver->size * sizeof(int));
     displs = malloc(solver->size * sizeof(int));
@@ -355,6 +773,8 @@ int solver_mpi_gather(struct solver_data *solver, double *data) {
   range *= JMAX; 
   range *= KMAX;
   
+  if(solver->size == 1) return 0; /* rank 0 already holds the whole mesh */
+
   if (!initialized) {
 	  cnts = malloc(solver->size * sizeof(int));
 	  displs = malloc(solver->size * sizeof(int));
@@ -381,36 +801,29 @@ int solver_mpi_gather(struct solver_data *solver, double *data) {
 
 int solver_send_all(struct solver_data *solver) {
   long int range, start;
-  int size, rank, n;
+  int size, n;
   struct kE_data *kE;
 
-  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-  MPI_Comm_size(MPI_COMM_WORLD, &size);
-  
-  range = (IMAX + (size - 1)) / size;
+  size = solver->cart_dims[0];
   
   for(n=1; n<size; n++) {
-    start = range * n;
-    start -= 1;	
-    start = max(start, 0);
-    
-    if(start + range + 2 > IMAX) range = IMAX - start - 2;
+    solver_mpi_extent(solver, n, &start, &range);
     
-    solver_mpi_send(solver, solver->mesh->fv, n, start, range + 2);
-    solver_mpi_send(solver, solver->mesh->ae, n, start, range + 2);
-    solver_mpi_send(solver, solver->mesh->an, n, start, range + 2);
-    solver_mpi_send(solver, solver->mesh->at, n, start, range + 2);
-    solver_mpi_send(solver, solver->mesh->vof, n, start, range + 2);
-    solver_mpi_send(solver, solver->mesh->P, n, start, range + 2);
-    solver_mpi_send(solver, solver->mesh->u, n, start, range + 2);
-    solver_mpi_send(solver, solver->mesh->v, n, start, range + 2);
-    solver_mpi_send(solver, solver->mesh->w, n, start, range + 2);
+    solver_mpi_send(solver, solver->mesh->fv, n, start, range);
+    solver_mpi_send(solver, solver->mesh->ae, n, start, range);
+    solver_mpi_send(solver, solver->mesh->an, n, start, range);
+    solver_mpi_send(solver, solver->mesh->at, n, start, range);
+    solver_mpi_send(solver, solver->mesh->vof, n, start, range);
+    solver_mpi_send(solver, solver->mesh->P, n, start, range);
+    solver_mpi_send(solver, solver->mesh->u, n, start, range);
+    solver_mpi_send(solver, solver->mesh->v, n, start, range);
+    solver_mpi_send(solver, solver->mesh->w, n, start, range);
     
     if(kE_check(solver))  {
       kE = solver->mesh->turbulence_model;
-      solver_mpi_send(solver, kE->k, n, start, range + 2);
-      solver_mpi_send(solver, kE->E, n, start, range + 2);
-      solver_mpi_send(solver, kE->nu_t, n, start, range + 2);
+      solver_mpi_send(solver, kE->k, n, start, range);
+      solver_mpi_send(solver, kE->E, n, start, range);
+      solver_mpi_send(solver, kE->nu_t, n, start, range);
     }
   }
 
@@ -505,6 +918,100 @@ double solver_mpi_min(struct solver_data *solver, double x) {
   return ret;
 }
 
+/* scalars reduced together.  kernels register the address of their local
+ * contribution with solver_reduce_add, and solver_reduce replaces each one
+ * by its sum, maximum or minimum over the ranks in a single MPI_Allreduce.
+ * each value travels as a {value, op} pair, so solver_reduce_op applies the
+ * right op to any chunk of the buffer MPI hands it */
+static struct {
+  int count, size;
+  double **value;
+  enum solver_reduce_ops *op;
+  double *buffer;  /* the {value, op} pairs */
+  int ready;
+  MPI_Datatype pair;
+  MPI_Op mpi_op;
+} reduce;
+
+static void solver_reduce_op(void *in, void *inout, int *len, MPI_Datatype *type) {
+  const double *a = in;
+  double *b = inout;
+  int n;
+
+  (void) type; /* always reduce.pair, each holding its own op */
+
+  for(n = 0; n < *len; n++) {
+    switch((int) b[2*n+1]) {
+    case reduce_sum:
+      b[2*n] += a[2*n];
+      break;
+    case reduce_max:
+      b[2*n] = max(a[2*n], b[2*n]);
+      break;
+    case reduce_min:
+      b[2*n] = min(a[2*n], b[2*n]);
+      break;
+    }
+  }
+}
+
+int solver_reduce_add(struct solver_data *solver, enum solver_reduce_ops op, double *x) {
+  double **value;
+  enum solver_reduce_ops *ops;
+  double *buffer;
+  int size;
+
+  if(reduce.count == reduce.size) {
+    size = max(2 * reduce.size, 16);
+    value = realloc(reduce.value, sizeof(double *) * size);
+    if(value != NULL) reduce.value = value;
+    ops = realloc(reduce.op, sizeof(enum solver_reduce_ops) * size);
+    if(ops != NULL) reduce.op = ops;
+    buffer = realloc(reduce.buffer, sizeof(double) * 2 * size);
+    if(buffer != NULL) reduce.buffer = buffer;
+    if(value == NULL || ops == NULL || buffer == NULL) {
+      printf("error: could not allocate %d reduced values on rank %d\n", size, solver->rank);
+      return 1;
+    }
+    reduce.size = size;
+  }
+
+  reduce.value[reduce.count] = x;
+  reduce.op[reduce.count] = op;
+  reduce.count++;
+
+  return 0;
+}
+
+int solver_reduce(struct solver_data *solver) {
+  int n;
+
+  if(reduce.count == 0) return 0;
+
+  if(solver->size > 1) {
+    if(!reduce.ready) {
+      MPI_Type_contiguous(2, MPI_DOUBLE, &reduce.pair);
+      MPI_Type_commit(&reduce.pair);
+      MPI_Op_create(solver_reduce_op, 1, &reduce.mpi_op);
+      reduce.ready = 1;
+    }
+
+    for(n = 0; n < reduce.count; n++) {
+      reduce.buffer[2*n] = *reduce.value[n];
+      reduce.buffer[2*n+1] = reduce.op[n];
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, reduce.buffer, reduce.count, reduce.pair, reduce.mpi_op, MPI_COMM_WORLD);
+
+    for(n = 0; n < reduce.count; n++)
+      *reduce.value[n] = reduce.buffer[2*n];
+  }
+
+  reduce.count = 0;
+
+  return 0;
+}
+
 int solver_broadcast_all(struct solver_data *solver) {
   int rank, turb, autot;
   
@@ -518,9 +1025,34 @@ int solver_broadcast_all(struct solver_data *solver) {
   MPI_Bcast(&solver->t, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
   MPI_Bcast(&solver->endt, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
   MPI_Bcast(&solver->writet, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->checkpointt, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
   MPI_Bcast(&solver->delt, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
   MPI_Bcast(&solver->abstol, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
   MPI_Bcast(&solver->reltol, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->threads, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->distributed, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->output_buffers, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->output_drop, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->vtk_compression, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->vtk_raw, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->vtk_float32, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->pressure_pc, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->pressure_ksp, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->pressure_line_gs, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->pressure_line_smoother, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->pressure_pc_single, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->pressure_matrix_free, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->pressure_pc_reuse, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->pressure_pc_reuse_iter, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->pressure_pc_reuse_changed, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->pressure_warm_start, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->pressure_active_only, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->viscous_implicit, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->viscous_iter, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->viscous_tol, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->balance, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->balance_fluid, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&solver->balance_limit, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
   
   if(!rank) {
     if(kE_check(solver)) turb = 1;
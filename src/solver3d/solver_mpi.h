@@ -5,10 +5,18 @@
 */
 
 int solver_mpi_range(struct solver_data *solver);
+int solver_mpi_wall(struct solver_data *solver, int face);
+int solver_mpi_balance(struct solver_data *solver);
+double solver_mpi_balance_report(struct solver_data *solver);
 int solver_mpi(struct solver_data *solver, double timestep, double delt);
 int solver_mpi_high_rank(struct solver_data *solver, double timestep);
 int solver_recv_all(struct solver_data *solver);
 int solver_sendrecv_edge(struct solver_data *solver, double *data);
+int solver_halo_init(struct solver_data *solver, struct solver_halo *halo, int tag, int fields, double **data);
+int solver_halo_begin(struct solver_data *solver, struct solver_halo *halo);
+int solver_halo_end(struct solver_data *solver, struct solver_halo *halo);
+int solver_halo_exchange(struct solver_data *solver, struct solver_halo *halo);
+void solver_halo_free(struct solver_data *solver, struct solver_halo *halo);
 int solver_sendrecv_edge_int(struct solver_data *solver, int *data);
 int solver_send_all(struct solver_data *solver);
 int solver_mpi_send(struct solver_data *solver, double *data, int to, long int i_start, long int i_range);
@@ -24,8 +32,14 @@ double solver_mpi_max(struct solver_data *solver, double x);
 double solver_mpi_min(struct solver_data *solver, double x); 
 int solver_mpi_init_comm(struct solver_data *solver);
 double solver_mpi_sum(struct solver_data *solver, double x);
+int solver_reduce_add(struct solver_data *solver, enum solver_reduce_ops op, double *x);
+int solver_reduce(struct solver_data *solver);
 int solver_sendrecv_delu(struct solver_data *solver);
 int solver_mpi_sendrecv_replace(struct solver_data *solver, double *data, long int start, long int range, int to, int from);
 int solver_mpi_init_complete(struct solver_data *solver);
+int solver_mpi_piece(struct solver_data *solver);
+int solver_mpi_piece_extents(struct solver_data *solver);
+int solver_mpi_load(struct solver_data *solver, double timestep);
+int solver_mpi_fill_vof(struct solver_data *solver, double *vector);
 int solver_mpi_gather(struct solver_data *solver, double *data);
 int solver_mpi_gather_int(struct solver_data *solver, int *data);
\ No newline at end of file
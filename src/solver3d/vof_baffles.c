@@ -155,11 +155,35 @@ int vof_baffles_write(struct solver_data *solver) {
   return 0;
 }
 
+/* cells counted by each swirl baffle */
+static double *swirl_counts = NULL;
+static long int swirl_counts_size = 0;
+
 int vof_baffles(struct solver_data *solver) {
   int x;
+  long int n;
   struct baffle_data *baffle;
+  double *counts;
 #define emf solver->emf  
 
+  /* the flow and swirl baffles register their sums, which one reduction
+   * after the loop adds up over the ranks */
+  n = 0;
+  for(x=0; x < 3; x++)
+    for(baffle = solver->mesh->baffles[x]; baffle != NULL; baffle = baffle->next)
+      if(baffle->type == swirl_angle) n++;
+
+  if(n > swirl_counts_size) {
+    counts = realloc(swirl_counts, sizeof(double) * n);
+    if(counts == NULL) {
+      printf("error: could not allocate the counts of %ld swirl baffles\n", n);
+      return 1;
+    }
+    swirl_counts = counts;
+    swirl_counts_size = n;
+  }
+
+  n = 0;
   for(x=0; x < 3; x++) {
     for(baffle = solver->mesh->baffles[x]; baffle != NULL; baffle = baffle->next) {    
         switch(baffle->type) {
@@ -181,7 +205,7 @@ int vof_baffles(struct solver_data *solver) {
         case swirl_angle:
           baffle_swirl(solver, x, baffle->extent_a[0], baffle->extent_a[1], 
                                      baffle->extent_b[0], baffle->extent_b[1], 
-                                     &(baffle->value), baffle->pos);
+                                     &(baffle->value), &swirl_counts[n++], baffle->pos);
           break;     
         case v_deviation:
           baffle_velocity_dev(solver, x, baffle->extent_a[0], baffle->extent_a[1], 
@@ -192,6 +216,17 @@ int vof_baffles(struct solver_data *solver) {
     }
   }
 
+  if(solver_reduce(solver)) return 1;
+
+  n = 0;
+  for(x=0; x < 3; x++) {
+    for(baffle = solver->mesh->baffles[x]; baffle != NULL; baffle = baffle->next) {
+      if(baffle->type != swirl_angle) continue;
+      baffle->value /= swirl_counts[n++];
+      if(isnan(baffle->value)) baffle->value = 0;
+    }
+  }
+
   return 0;
 #undef emf
 }
@@ -302,12 +337,10 @@ int baffle_flow(struct solver_data *solver,
 
   long int i, j, k, imin, jmin, kmin, imax, jmax, kmax;
   
-  if(baffle_setup(solver, x, pos, &imin, &jmin, &kmin, &imax, &jmax, &kmax, min_1, min_2, max_1, max_2)) {
-    *value = solver_mpi_sum(solver, 0);
-    return 0;
-  }
-  
   *value = 0;
+
+  if(baffle_setup(solver, x, pos, &imin, &jmin, &kmin, &imax, &jmax, &kmax, min_1, min_2, max_1, max_2))
+    return solver_reduce_add(solver, reduce_sum, value);
   
   for(i=imin; i <= imax; i++) {
     for(j=jmin; j <= jmax; j++) {
@@ -327,28 +360,28 @@ int baffle_flow(struct solver_data *solver,
     }
   }
 
-  *value = solver_mpi_sum(solver, *value);
-
-  return 0;
+  return solver_reduce_add(solver, reduce_sum, value);
 }
 
+/* registers the swirl angles summed in value and the cells counted, which
+ * vof_baffles turns into the mean angle once they are summed over the ranks */
 int baffle_swirl(struct solver_data *solver, 
                             int x, double min_1, double min_2, double max_1, double max_2, 
-                            double *value, long int pos) {
+                            double *value, double *count_ref, long int pos) {
 
   long int i, j, k, imin, jmin, kmin, imax, jmax, kmax;
   double count;
   double swirl, u_ave, v_ave, w_ave;
   
+  *value = 0;
+  *count_ref = 0;
+
   if(baffle_setup(solver, x, pos, &imin, &jmin, &kmin, &imax, &jmax, &kmax, min_1, min_2, max_1, max_2)) {
-    swirl = solver_mpi_sum(solver, 0);
-    count = solver_mpi_sum(solver, 0);
-    *value = swirl / count;
-    if(isnan(*value)) *value = 0;
+    if(solver_reduce_add(solver, reduce_sum, value) ||
+       solver_reduce_add(solver, reduce_sum, count_ref))
+      return 1;
     return 0;
   }
-
-  *value = 0;
   
   imin = max(imin-1,0);
   jmin = max(jmin-1,0);
@@ -397,10 +430,11 @@ int baffle_swirl(struct solver_data *solver,
     }
   }
   
-  swirl = solver_mpi_sum(solver, swirl);
-  count = solver_mpi_sum(solver, count);
-  *value = swirl / count;
-  if(isnan(*value)) *value = 0;
+  *value = swirl;
+  *count_ref = count;
+  if(solver_reduce_add(solver, reduce_sum, value) ||
+     solver_reduce_add(solver, reduce_sum, count_ref))
+    return 1;
   
   return 0;
 }
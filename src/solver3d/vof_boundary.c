@@ -213,19 +213,19 @@ int boundary_hgl(struct solver_data *solver,
         
              
         /* ADDED 01/10/2014 */
-        if(mesh->vof[mesh_index(mesh,i,j,k)] == 1.0) {
-          mesh->P[mesh_index(mesh,i,j,k)] = 
-            mesh->P[mesh_index(mesh,i,j,k+1)] + 
+        if(mesh->vof[mesh_offset(mesh,i,j,k)] == 1.0) {
+          mesh->P[mesh_offset(mesh,i,j,k)] = 
+            mesh->P[mesh_offset(mesh,i,j,k+1)] + 
             (mesh->delz * solver->rho * fabs(solver->gz)) * 
-            (0.5 + min(mesh->vof[mesh_index(mesh,i,j,k+1)],0.5));
+            (0.5 + min(mesh->vof[mesh_offset(mesh,i,j,k+1)],0.5));
 
         }
-        else  if(mesh->vof[mesh_index(mesh,i,j,k)] > 0.0) {
-          mesh->P[mesh_index(mesh,i,j,k)] = 
-            mesh->delz * solver->rho * fabs(solver->gz) * max(-0.5,mesh->vof[mesh_index(mesh,i,j,k)] - 0.5);          
+        else  if(mesh->vof[mesh_offset(mesh,i,j,k)] > 0.0) {
+          mesh->P[mesh_offset(mesh,i,j,k)] = 
+            mesh->delz * solver->rho * fabs(solver->gz) * max(-0.5,mesh->vof[mesh_offset(mesh,i,j,k)] - 0.5);          
         }
-        else if(mesh->vof[mesh_index(mesh,i,j,k)] <= 0.0) 
-          mesh->P[mesh_index(mesh,i,j,k)] = 0.0;
+        else if(mesh->vof[mesh_offset(mesh,i,j,k)] <= 0.0) 
+          mesh->P[mesh_offset(mesh,i,j,k)] = 0.0;
           
         if(FV(i,j,k) < 0.000001) continue;
         P(i+coplanar[0],j+coplanar[1],k+coplanar[2]) = P(i,j,k); 
@@ -238,6 +238,8 @@ int boundary_hgl(struct solver_data *solver,
   return 0;
 }
 
+/* the flow through the faces next to a boundary and their wetted area, over
+ * the cells of this rank.  vof_special_boundaries sums them over the ranks */
 double calc_flow(struct solver_data *solver, int x, long int imin, long int imax, 
                  long int jmin, long int jmax, long int kmin, long int kmax, double *area_ref) {
   long int i,j,k;
@@ -300,24 +302,20 @@ double calc_flow(struct solver_data *solver, int x, long int imin, long int imax
   }
   *area_ref = area;
 
-  flow = solver_mpi_sum(solver, flow);
-
   return flow;
 }
 
 int boundary_weir(struct solver_data *solver, 
                             int x, double min_1, double min_2, double max_1, double max_2, 
-                            double value, double turbulence) {
+                            double value, double turbulence, double flow) {
 #define emf solver->emf  
 
   long int i, j, k, imin, jmin, kmin, imax, jmax, kmax, l, m, n;
-  double flow, area, height, ave_height, count, head, sgn; 
+  double height, ave_height, count, head, sgn; 
   double coplanar[3] = {0, 0, 0};
   
   sboundary_setup(solver, x, &imin, &jmin, &kmin, &imax, &jmax, &kmax, min_1, min_2, max_1, max_2);
 
-  flow = 0;
-  area = 0;
   sgn  = 1.0;
   
   if(x>3) return 0;
@@ -351,7 +349,6 @@ int boundary_weir(struct solver_data *solver,
     break;
   }
   
-  flow = calc_flow(solver, x, imin, imax, jmin, jmax, kmin, kmax, &area);
   flow *= sgn;
   
   count = 0;
@@ -405,22 +402,9 @@ int boundary_weir(struct solver_data *solver,
   return 0;
 }
 
-int boundary_mass_outflow(struct solver_data *solver, 
-                            int x, double min_1, double min_2, double max_1, double max_2, 
-                            double value, double turbulence) {
-#define emf solver->emf  
-
-  long int i, j, k, imin, jmin, kmin, imax, jmax, kmax;
-  
-  sboundary_setup(solver, x, &imin, &jmin, &kmin, &imax, &jmax, &kmax, min_1, min_2, max_1, max_2);
-  
-  double flow, area, area_0, flow_factor;
-  flow = 0;
-  area = 0;
-  
-  
-  /* this is outflow so set value so that it is positive on an east/north/top boundary, and
-  negative otherwise */
+/* this is outflow so set value so that it is positive on an east/north/top boundary, and
+ * negative otherwise */
+static double outflow_value(int x, double value) {
   value = fabs(value);
   
   switch(x) {
@@ -430,6 +414,19 @@ int boundary_mass_outflow(struct solver_data *solver,
     value *= -1.0;
     break;
   }
+
+  return value;
+}
+
+/* as calc_flow, counting only the faces flowing out through a mass outflow */
+double calc_outflow(struct solver_data *solver, int x, long int imin, long int imax, 
+                    long int jmin, long int jmax, long int kmin, long int kmax, double value, double *area_ref) {
+  long int i, j, k;
+  double flow, area, area_0;
+
+  value = outflow_value(x, value);
+  flow = 0;
+  area = 0;
   
   for(i=imin; i <= imax; i++) {
     for(j=jmin; j <= jmax; j++) {
@@ -482,9 +479,22 @@ int boundary_mass_outflow(struct solver_data *solver,
     }
   }
 
-  /* ADDED 7/27/18 */
-  flow = solver_mpi_sum(solver, flow);
-  area = solver_mpi_sum(solver, area);
+  *area_ref = area;
+
+  return flow;
+}
+
+int boundary_mass_outflow(struct solver_data *solver, 
+                            int x, double min_1, double min_2, double max_1, double max_2, 
+                            double value, double turbulence, double flow, double area) {
+#define emf solver->emf  
+
+  long int i, j, k, imin, jmin, kmin, imax, jmax, kmax;
+  double flow_factor;
+  
+  sboundary_setup(solver, x, &imin, &jmin, &kmin, &imax, &jmax, &kmax, min_1, min_2, max_1, max_2);
+  
+  value = outflow_value(x, value);
 
   if(fabs(flow) < 0.1 * fabs(value) || flow * value < 0) { 
     /* in the case of no flow or reverse flow, we set a fixed velocity to start the solution */
@@ -622,14 +632,14 @@ int boundary_fixed_velocity(struct solver_data *solver,
         switch(x) {
         case 0:
           if(value > 0)
-            VOF(i,j,k) = mesh_n->vof[mesh_index(solver->mesh,i,j,k)];
+            VOF(i,j,k) = mesh_n->vof[mesh_offset(solver->mesh,i,j,k)];
           U(i,j,k) = value;
           V(i,j,k) = 0;
           W(i,j,k) = 0;
           break;
         case 1:
           if(value < 0)
-            VOF(i,j,k) = mesh_n->vof[mesh_index(solver->mesh,i,j,k)];
+            VOF(i,j,k) = mesh_n->vof[mesh_offset(solver->mesh,i,j,k)];
           U(i,j,k) = value;
           U(i-1,j,k) = value;
           V(i,j,k) = 0;
@@ -637,14 +647,14 @@ int boundary_fixed_velocity(struct solver_data *solver,
           break;
         case 2:
           if(value > 0)
-            VOF(i,j,k) = mesh_n->vof[mesh_index(solver->mesh,i,j,k)];
+            VOF(i,j,k) = mesh_n->vof[mesh_offset(solver->mesh,i,j,k)];
           U(i,j,k) = 0;
           V(i,j,k) = value;
           W(i,j,k) = 0;
           break; 
         case 3:
           if(value < 0)
-            VOF(i,j,k) = mesh_n->vof[mesh_index(solver->mesh,i,j,k)];
+            VOF(i,j,k) = mesh_n->vof[mesh_offset(solver->mesh,i,j,k)];
           U(i,j,k) = 0;
           V(i,j,k) = value;
           V(i,j-1,k) = value;
@@ -652,14 +662,14 @@ int boundary_fixed_velocity(struct solver_data *solver,
           break;    
         case 4:
           if(value > 0)
-            VOF(i,j,k) = mesh_n->vof[mesh_index(solver->mesh,i,j,k)];
+            VOF(i,j,k) = mesh_n->vof[mesh_offset(solver->mesh,i,j,k)];
           U(i,j,k) = 0;
           V(i,j,k) = 0;
           W(i,j,k) = value;
           break;   
         case 5:
           if(value < 0)
-            VOF(i,j,k) = mesh_n->vof[mesh_index(solver->mesh,i,j,k)];
+            VOF(i,j,k) = mesh_n->vof[mesh_offset(solver->mesh,i,j,k)];
           U(i,j,k) = 0;
           V(i,j,k) = 0;
           W(i,j,k) = value;
@@ -674,11 +684,63 @@ int boundary_fixed_velocity(struct solver_data *solver,
   return 0;
 }
 
+/* flow and area measured at each weir and mass outflow */
+static double *sb_flows = NULL;
+static long int sb_flows_size = 0;
+
+/* measures the flows of the weirs and mass outflows and sums them over the
+ * ranks in one reduction, in the order vof_special_boundaries takes them */
+static int vof_special_boundaries_flows(struct solver_data *solver) {
+  long int imin, jmin, kmin, imax, jmax, kmax, n;
+  struct sb_data *sb;
+  double *flows;
+  int x;
+
+  n = 0;
+  for(x=0; x < 6; x++)
+    for(sb = solver->mesh->sb[x]; sb != NULL; sb = sb->next)
+      if(sb->type == mass_outflow || sb->type == weir) n++;
+
+  if(2 * n > sb_flows_size) {
+    flows = realloc(sb_flows, sizeof(double) * 2 * n);
+    if(flows == NULL) {
+      printf("error: could not allocate the flows of %ld special boundaries\n", n);
+      return 1;
+    }
+    sb_flows = flows;
+    sb_flows_size = 2 * n;
+  }
+
+  n = 0;
+  for(x=0; x < 6; x++) {
+    for(sb = solver->mesh->sb[x]; sb != NULL; sb = sb->next) {
+      if(sb->type != mass_outflow && sb->type != weir) continue;
+
+      sboundary_setup(solver, x, &imin, &jmin, &kmin, &imax, &jmax, &kmax, 
+                      sb->extent_a[0], sb->extent_a[1], sb->extent_b[0], sb->extent_b[1]);
+      if(sb->type == mass_outflow)
+        sb_flows[n] = calc_outflow(solver, x, imin, imax, jmin, jmax, kmin, kmax, sb->value, &sb_flows[n+1]);
+      else
+        sb_flows[n] = calc_flow(solver, x, imin, imax, jmin, jmax, kmin, kmax, &sb_flows[n+1]);
+
+      if(solver_reduce_add(solver, reduce_sum, &sb_flows[n]) ||
+         solver_reduce_add(solver, reduce_sum, &sb_flows[n+1]))
+        return 1;
+      n += 2;
+    }
+  }
+
+  return solver_reduce(solver);
+}
+
 int vof_special_boundaries(struct solver_data *solver) {
   int x;
+  long int n = 0;
   struct sb_data *sb;
 #define emf solver->emf  
 
+  if(vof_special_boundaries_flows(solver)) return 1;
+
   for(x=0; x < 6; x++) {
     for(sb = solver->mesh->sb[x]; sb != NULL; sb = sb->next) {    
         switch(sb->type) {
@@ -690,7 +752,8 @@ int vof_special_boundaries(struct solver_data *solver) {
         case mass_outflow:
           boundary_mass_outflow(solver, x, sb->extent_a[0], sb->extent_a[1], 
                                      sb->extent_b[0], sb->extent_b[1], 
-                                     sb->value, sb->turbulence);
+                                     sb->value, sb->turbulence, sb_flows[n], sb_flows[n+1]);
+          n += 2;
           break;
         case hgl:
          	boundary_hgl(solver, x, sb->extent_a[0], sb->extent_a[1], 
@@ -700,7 +763,8 @@ int vof_special_boundaries(struct solver_data *solver) {
       	case weir:
           boundary_weir(solver, x, sb->extent_a[0], sb->extent_a[1], 
                                      sb->extent_b[0], sb->extent_b[1], 
-                                     sb->value, sb->turbulence);
+                                     sb->value, sb->turbulence, sb_flows[n]);
+          n += 2;
           break;
           
         }
@@ -720,12 +784,16 @@ int vof_boundaries(struct solver_data *solver) {
   double dv, dA, delp;
   
   
+  /* wall boundaries only touch their own row of cells, so they are threaded.  the free surface
+   * sweep below stays serial since each cell overwrites the faces of its neighbours */
+
   /* first boundaries on x-axis */
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) private(j, k) schedule(static)
   for(j=0; j<JMAX; j++) {
     for(k=0; k<KMAX; k++) {
 
       /* west boundary */
-      if(ISTART == 0) {
+      if(solver_mpi_wall(solver, 0)) {
         if(vof_boundaries_check_inside_sb(solver, j, k, 0) == wall) {    
           switch(solver->mesh->wb[0]) {
           case slip:
@@ -755,7 +823,7 @@ int vof_boundaries(struct solver_data *solver) {
       }
       
       /* east boundary */
-      if(IRANGE + ISTART == IMAX) {
+      if(solver_mpi_wall(solver, 1)) {
         if(vof_boundaries_check_inside_sb(solver, j, k, 1) == wall) {    
           switch(solver->mesh->wb[1]) {
           case slip:
@@ -791,6 +859,7 @@ int vof_boundaries(struct solver_data *solver) {
   }
   
   /* boundaries on y-axis */
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) private(i, j, k) schedule(static)
   for(i=0; i<IRANGE; i++) {
     for(k=0; k<KMAX; k++) {
          
@@ -858,6 +927,7 @@ int vof_boundaries(struct solver_data *solver) {
   
     
   /* boundaries on z-axis */
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) private(i, j) schedule(static)
   for(i=0; i<IRANGE; i++) {
     for(j=0; j<JMAX; j++) {
          
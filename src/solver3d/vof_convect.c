@@ -173,50 +173,106 @@ double calc_dVOF(struct solver_data *solver, long int i, long int j, long int k,
 
 }
 
-int vof_mpi_convect(struct solver_data *solver) {
+/* advect the vof across the faces of planes ibegin to iend-1.  when lead_in is set the x flux
+ * entering plane ibegin from ibegin-1 is applied first, and the x flux leaving plane iend-1 is
+ * skipped unless lead_out is set.  this lets each thread own a block of planes and still apply 
+ * every flux in the same order as a single serial sweep */
+int vof_convect_planes(struct solver_data *solver, long int ibegin, long int iend, 
+                       int lead_in, int lead_out) {
   long int i,j,k;
-  double vchg = 0.0;
   double dVOF;
 
 #define emf solver->emf
 
-  solver->vof_flag = 0;
-  
-  if(solver->t > 0) {
-  /* this code only executes after the first timestep */
-    for(i=0; i<IRANGE-1; i++) {
-      for(j=0; j<JMAX-1; j++) {
-        for(k=0; k<KMAX-1; k++) { 
+  if(lead_in) {
+    i = ibegin - 1;
+    for(j=0; j<JMAX-1; j++) {
+      for(k=0; k<KMAX-1; k++) { 
+        if(FV(i,j,k) < emf) continue;
+
+        if(FV(i+1,j,k) > emf) {
+          dVOF = calc_dVOF(solver, i, j, k, 0);
+          VOF(i+1,j,k) += dVOF * RDX * AE(i,j,k) / FV(i+1,j,k);
+        }
+      }
+    }
+  }
+
+  for(i=ibegin; i<iend; i++) {
+    for(j=0; j<JMAX-1; j++) {
+      for(k=0; k<KMAX-1; k++) { 
 
-          if(FV(i,j,k) < emf) continue;
+        if(FV(i,j,k) < emf) continue;
 
-          if(FV(i+1,j,k) > emf) {
-            dVOF = calc_dVOF(solver, i, j, k, 0);
-            VOF(i,j,k) -= dVOF * RDX * AE(i,j,k) / FV(i,j,k);
+        if(FV(i+1,j,k) > emf) {
+          dVOF = calc_dVOF(solver, i, j, k, 0);
+          VOF(i,j,k) -= dVOF * RDX * AE(i,j,k) / FV(i,j,k);
+          if(i < iend-1 || lead_out) 
             VOF(i+1,j,k) += dVOF * RDX * AE(i,j,k) / FV(i+1,j,k);
-          }
+        }
 
-          if(FV(i,j+1,k) > emf) {
-            dVOF = calc_dVOF(solver, i, j, k, 1);
-            VOF(i,j,k) -= dVOF * RDY * AN(i,j,k) / FV(i,j,k);
-            VOF(i,j+1,k) += dVOF * RDY * AN(i,j,k) / FV(i,j+1,k);
-          }
+        if(FV(i,j+1,k) > emf) {
+          dVOF = calc_dVOF(solver, i, j, k, 1);
+          VOF(i,j,k) -= dVOF * RDY * AN(i,j,k) / FV(i,j,k);
+          VOF(i,j+1,k) += dVOF * RDY * AN(i,j,k) / FV(i,j+1,k);
+        }
 
-          if(FV(i,j,k+1) > emf) {
-            dVOF = calc_dVOF(solver, i, j, k, 2);
-            VOF(i,j,k) -= dVOF * RDZ * AT(i,j,k) / FV(i,j,k);
-            VOF(i,j,k+1) += dVOF * RDZ * AT(i,j,k) / FV(i,j,k+1);
-          }
+        if(FV(i,j,k+1) > emf) {
+          dVOF = calc_dVOF(solver, i, j, k, 2);
+          VOF(i,j,k) -= dVOF * RDZ * AT(i,j,k) / FV(i,j,k);
+          VOF(i,j,k+1) += dVOF * RDZ * AT(i,j,k) / FV(i,j,k+1);
         }
       }
     }
+  }
+
+  return 0;
+#undef emf
+}
+
+int vof_mpi_convect(struct solver_data *solver) {
+  long int i,j,k;
+  long int nplanes, first;
+  int nthreads;
+  double vchg = 0.0;
+
+  solver->vof_flag = 0;
+  
+  if(solver->t > 0) {
+  /* this code only executes after the first timestep */
+    /* planes from 2 on read no halo velocities, so they are advected
+     * while the halo exchange is in flight.  planes 0 and 1 follow once
+     * it is done, the flux from plane 1 into 2 having been applied by the
+     * lead in of the first block as a serial sweep would */
+    nplanes = IRANGE-1;
+    first = min(2, nplanes);
+    nthreads = (int) min(solver->threads, nplanes - first);
+    if(nthreads < 1) nthreads = 1;
+
+#pragma omp parallel if(nthreads > 1) num_threads(nthreads)
+    {
+      int t  = omp_get_thread_num();
+      int nt = omp_get_num_threads();
+      long int ibegin = first + (nplanes - first) * t / nt;
+      long int iend   = first + (nplanes - first) * (t+1) / nt;
+
+      if(ibegin < iend)
+        vof_convect_planes(solver, ibegin, iend, ibegin > 0, t == nt-1);
+    }
+
+    solver_halo_end(solver, &solver->halo);
+    vof_convect_planes(solver, 0, first, 0, first == nplanes);
   } 
 
+  /* the clean up below writes the west halo velocities */
+  solver_halo_end(solver, &solver->halo);
+
 #define min_vof solver->min_vof
 #define max_vof solver->max_vof
 
   /* # this code executes on any timestep
-  # it calculates how much VOF is being lost or gained in the solution */
+  # it calculates how much VOF is being lost or gained in the solution 
+  # left serial: each cell reads neighbours already cleaned up in this sweep */
   for(i=1; i<IRANGE-1; i++) {
     for(j=1; j<JMAX-1; j++) {
       for(k=1; k<KMAX-1; k++) {
@@ -273,7 +329,6 @@ int vof_mpi_convect(struct solver_data *solver) {
   }
 
   return 0;
-#undef emf
 #undef min_vof
 #undef max_vof
 }
@@ -13,46 +13,46 @@
 #endif
 
 /* macros to reduce code needed for access to array elements */
-#define U(i, j, k) solver->mesh->u[mesh_index(solver->mesh, i, j, k)]
-#define V(i, j, k) solver->mesh->v[mesh_index(solver->mesh, i, j, k)]
-#define W(i, j, k) solver->mesh->w[mesh_index(solver->mesh, i, j, k)]
-#define U_OMEGA(i, j, k) solver->mesh->u_omega[mesh_index(solver->mesh, i, j, k)]
-#define V_OMEGA(i, j, k) solver->mesh->v_omega[mesh_index(solver->mesh, i, j, k)]
-#define W_OMEGA(i, j, k) solver->mesh->w_omega[mesh_index(solver->mesh, i, j, k)]
-#define UN(i, j, k) mesh_n->u[mesh_index(mesh_n, i, j, k)]
-#define VN(i, j, k) mesh_n->v[mesh_index(mesh_n, i, j, k)]
-#define WN(i, j, k) mesh_n->w[mesh_index(mesh_n, i, j, k)]
-#define P(i, j, k) solver->mesh->P[mesh_index(solver->mesh, i, j, k)]
-#define PN(i, j, k) mesh_n->P[mesh_index(mesh_n, i, j, k)]
+#define U(i, j, k) solver->mesh->u[mesh_offset(solver->mesh, i, j, k)]
+#define V(i, j, k) solver->mesh->v[mesh_offset(solver->mesh, i, j, k)]
+#define W(i, j, k) solver->mesh->w[mesh_offset(solver->mesh, i, j, k)]
+#define U_OMEGA(i, j, k) solver->mesh->u_omega[mesh_offset(solver->mesh, i, j, k)]
+#define V_OMEGA(i, j, k) solver->mesh->v_omega[mesh_offset(solver->mesh, i, j, k)]
+#define W_OMEGA(i, j, k) solver->mesh->w_omega[mesh_offset(solver->mesh, i, j, k)]
+#define UN(i, j, k) mesh_n->u[mesh_offset(mesh_n, i, j, k)]
+#define VN(i, j, k) mesh_n->v[mesh_offset(mesh_n, i, j, k)]
+#define WN(i, j, k) mesh_n->w[mesh_offset(mesh_n, i, j, k)]
+#define P(i, j, k) solver->mesh->P[mesh_offset(solver->mesh, i, j, k)]
+#define PN(i, j, k) mesh_n->P[mesh_offset(mesh_n, i, j, k)]
 
-#define VOF(i, j, k) solver->mesh->vof[mesh_index(solver->mesh, i, j, k)]
-#define VOF_N(i, j, k) mesh_n->vof[mesh_index(mesh_n, i, j, k)]
-#define N_VOF(i, j, k) solver->mesh->n_vof[mesh_index(solver->mesh, i, j, k)]
-#define N_VOF_N(i, j, k) mesh_n->n_vof[mesh_index(mesh_n, i, j, k)]
+#define VOF(i, j, k) solver->mesh->vof[mesh_offset(solver->mesh, i, j, k)]
+#define VOF_N(i, j, k) mesh_n->vof[mesh_offset(mesh_n, i, j, k)]
+#define N_VOF(i, j, k) solver->mesh->n_vof[mesh_offset(solver->mesh, i, j, k)]
+#define N_VOF_N(i, j, k) mesh_n->n_vof[mesh_offset(mesh_n, i, j, k)]
 
 
 #ifdef FV
 #undef FV
 #endif
-#define FV(i, j, k) solver->mesh->fv[mesh_index(solver->mesh, i, j, k)]
+#define FV(i, j, k) solver->mesh->fv[mesh_offset(solver->mesh, i, j, k)]
 
 #ifdef AE
 #undef AE
 #endif
-#define AE(i, j, k) solver->mesh->ae[mesh_index(solver->mesh, i, j, k)]
+#define AE(i, j, k) solver->mesh->ae[mesh_offset(solver->mesh, i, j, k)]
 
 #ifdef AN
 #undef AN
 #endif
-#define AN(i, j, k) solver->mesh->an[mesh_index(solver->mesh, i, j, k)]
+#define AN(i, j, k) solver->mesh->an[mesh_offset(solver->mesh, i, j, k)]
 
 #ifdef AT
 #undef AT
 #endif
-#define AT(i, j, k) solver->mesh->at[mesh_index(solver->mesh, i, j, k)]
+#define AT(i, j, k) solver->mesh->at[mesh_offset(solver->mesh, i, j, k)]
 
-#define NUT(i, j, k) solver->mesh->nut[mesh_index(solver->mesh, i, j, k)]
-#define NUT_N(i, j, k)  mesh_n->nut[mesh_index(solver->mesh, i, j, k)]
+#define NUT(i, j, k) solver->mesh->nut[mesh_offset(solver->mesh, i, j, k)]
+#define NUT_N(i, j, k)  mesh_n->nut[mesh_offset(solver->mesh, i, j, k)]
 
 #define DELX solver->mesh->delx
 #define DELY solver->mesh->dely
@@ -19,6 +19,8 @@
 #include "kE.h"
 #include "track.h"
 #include "vof_baffles.h"
+#include "vof_output.h"
+#include "checkpoint.h"
 #include "mesh_mpi.h"
 #include "solver_mpi.h"
 
@@ -83,11 +85,17 @@ int vof_mpi_init_solver(struct solver_data *solver) {
   mesh_n = mesh_mpi_init_copy(solver->mesh);
   if(mesh_n == NULL)
     return 1;
+
+  vof_output_init(solver);
   
   return 0;
 }
 
 int vof_mpi_kill_solver(struct solver_data *solver) {
+  vof_output_flush();
+  solver_halo_free(solver, &solver->halo);
+  solver_halo_free(solver, &solver->halo_velocity);
+  solver_halo_free(solver, &solver->halo_vof);
   mesh_free(solver->mesh);
   PetscEnd();
 
@@ -95,8 +103,14 @@ int vof_mpi_kill_solver(struct solver_data *solver) {
 }
 
 int vof_mpi_loop(struct solver_data *solver) {
-  double t_n;
+  double t_n, t_start;
+  double *flow[4] = { solver->mesh->u, solver->mesh->v, solver->mesh->w, solver->mesh->P };
 
+  /* the extent of each rank is settled by now */
+  if(solver_halo_init(solver, &solver->halo, 2, 4, flow) ||
+     solver_halo_init(solver, &solver->halo_velocity, 3, 3, flow) ||
+     solver_halo_init(solver, &solver->halo_vof, 4, 1, &solver->mesh->vof))
+    return 1;
   
   mesh_mpi_copy_data(mesh_n, solver->mesh);
 
@@ -126,20 +140,25 @@ int vof_mpi_loop(struct solver_data *solver) {
     track_cell(solver, TRACKCELL);
 #endif
 
+    t_start = MPI_Wtime();
     solver->velocity(solver);
+    vof_mpi_timer(solver, timer_velocity, t_start);
     
 #ifdef TRACKCELL
     printf("solver->velocity(solver);\n");
     track_cell(solver, TRACKCELL);
 #endif
 
+    t_start = MPI_Wtime();
     solver->wall_shear(solver); 
+    vof_mpi_timer(solver, timer_turbulence, t_start);
 
 #ifdef TRACKCELL
     printf("solver->wall_shear(solver);\n");
     track_cell(solver, TRACKCELL);
 #endif
 
+    t_start = MPI_Wtime();
     solver->boundaries(solver);
     
 #ifdef TRACKCELL
@@ -149,24 +168,28 @@ int vof_mpi_loop(struct solver_data *solver) {
 
     if(solver->special_boundaries != NULL)
       solver->special_boundaries(solver);
+    vof_mpi_timer(solver, timer_boundaries, t_start);
 
-    solver_sendrecv_edge(solver, solver->mesh->u);
-    solver_sendrecv_edge(solver, solver->mesh->v);
-    solver_sendrecv_edge(solver, solver->mesh->w);
+    t_start = MPI_Wtime();
+    solver_halo_exchange(solver, &solver->halo_velocity);
+    vof_mpi_timer(solver, timer_halo, t_start);
 
 #ifdef TRACKCELL
     printf("solver->special_boundaries(solver);\n");
     track_cell(solver, TRACKCELL);
 #endif
 
+    t_start = MPI_Wtime();
     solver->pressure(solver);
     if(solver->iter < 1) solver->iter = 1;
+    vof_mpi_timer(solver, timer_pressure, t_start);
 
 #ifdef TRACKCELL
     printf("solver->pressure(solver);\n");
     track_cell(solver, TRACKCELL);
 #endif 
 
+    t_start = MPI_Wtime();
     solver->boundaries(solver);
     if(solver->special_boundaries != NULL)
       solver->special_boundaries(solver);
@@ -178,45 +201,71 @@ int vof_mpi_loop(struct solver_data *solver) {
     solver->boundaries(solver);
     if(solver->special_boundaries != NULL)
       solver->special_boundaries(solver);
+    vof_mpi_timer(solver, timer_boundaries, t_start);
 
-    solver_sendrecv_edge(solver, solver->mesh->u);
-    solver_sendrecv_edge(solver, solver->mesh->v);
-    solver_sendrecv_edge(solver, solver->mesh->w); 
-    solver_sendrecv_edge(solver, solver->mesh->P);
+    /* the turbulence and convection kernels work on the inner planes
+     * while the halo planes are in flight, and finish the exchange before
+     * the planes next to them */
+    t_start = MPI_Wtime();
+    solver_halo_begin(solver, &solver->halo);
+    vof_mpi_timer(solver, timer_halo, t_start);
 
 #ifdef TRACKCELL
     printf("solver->boundaries(solver);\n");
     track_cell(solver, TRACKCELL);
 #endif
 
+    t_start = MPI_Wtime();
     solver->turbulence_loop(solver);
+    vof_mpi_timer(solver, timer_turbulence, t_start);
 
 #ifdef TRACKCELL
     printf("solver->turbulence_loop(solver);\n");
     track_cell(solver, TRACKCELL);
 #endif
 
+    t_start = MPI_Wtime();
     solver->convect(solver);
+    vof_mpi_timer(solver, timer_convect, t_start);
+
+    /* deltcal may restore the halo planes, so nothing can be left in flight */
+    t_start = MPI_Wtime();
+    solver_halo_end(solver, &solver->halo);
+    vof_mpi_timer(solver, timer_halo, t_start);
     
+    t_start = MPI_Wtime();
     solver->boundaries(solver);
     if(solver->special_boundaries != NULL)
       solver->special_boundaries(solver); 
-    solver_sendrecv_edge(solver, solver->mesh->vof);
+    vof_mpi_timer(solver, timer_boundaries, t_start);
+
+    t_start = MPI_Wtime();
+    solver_halo_exchange(solver, &solver->halo_vof);
+    vof_mpi_timer(solver, timer_halo, t_start);
       
+    t_start = MPI_Wtime();
     if(solver->deltcal != NULL) {
       if(solver->deltcal(solver) == 0) 
         mesh_mpi_copy_data(mesh_n, solver->mesh);
       else 
         solver->t = t_n;
     }
+    vof_mpi_timer(solver, timer_deltcal, t_start);
 
+    t_start = MPI_Wtime();
     if(solver->nvof != NULL)
       solver->nvof(solver);
+    vof_mpi_timer(solver, timer_nvof, t_start);
+
+    t_start = MPI_Wtime();
     solver_sendrecv_edge_int(solver, solver->mesh->n_vof);
+    vof_mpi_timer(solver, timer_halo, t_start);
 
     solver->output(solver);
          
+    t_start = MPI_Wtime();
     solver->write(solver); 
+    vof_mpi_timer(solver, timer_write, t_start);
   }
 
   solver->turbulence_kill(solver);
@@ -225,6 +274,45 @@ int vof_mpi_loop(struct solver_data *solver) {
   return 0;
 }
 
+void vof_mpi_timer(struct solver_data *solver, enum solver_timers timer, double t_start) {
+  solver->timer[timer] += MPI_Wtime() - t_start;
+}
+
+int vof_mpi_timer_output(struct solver_data *solver) {
+  const char *names[timer_count] = { "velocity", "pressure", "boundaries", "turbulence",
+                                     "convect", "nvof", "deltcal", "halo", "write" };
+  double t[timer_count], total, wait, hidden, active;
+  int n;
+
+  /* report the slowest rank, which sets the pace of the run */
+  total = 0;
+  for(n=0; n < timer_count; n++) {
+    t[n] = solver_mpi_max(solver, solver->timer[n]);
+    total += t[n];
+  }
+  wait = solver_mpi_sum(solver, solver->halo_wait);
+  hidden = solver_mpi_sum(solver, solver->halo_hidden);
+  active = solver_mpi_sum(solver, solver->pressure_active_rows);
+
+  if(solver->rank > 0) return 0;
+
+  printf("Kernel time with %d ranks x %d threads:\n", solver->size, solver->threads);
+  for(n=0; n < timer_count; n++) {
+    printf("  %-10s %10.3lf s  %5.1lf%%\n", names[n], t[n], total > 0 ? 100 * t[n] / total : 0);
+  }
+  if(hidden + wait > 0)
+    printf("Halo exchanges: %.3lf s waiting, %.3lf s in flight behind computation, %.1lf%% hidden\n",
+           wait, hidden, 100 * hidden / (hidden + wait));
+  if(solver->pressure_solves > 0)
+    printf("Pressure solves: %ld, %.1lf iterations each on average\n", solver->pressure_solves,
+           (double) solver->pressure_iter_total / solver->pressure_solves);
+  if(active > 0)
+    printf("Pressure system reduced to %.0lf of %ld rows\n", active, IMAX * JMAX * KMAX);
+  printf("\n");
+
+  return 0;
+}
+
 int vof_mpi_output(struct solver_data *solver) {
   time_t current;
   double elapsed;
@@ -232,10 +320,13 @@ int vof_mpi_output(struct solver_data *solver) {
   if(solver->rank > 0) return 0;
 
   if(solver->iter >= solver->niter) {
-    printf("timestep: %lf | delt: %lf | pressure did not converge\n", solver->t, solver->delt);
+    printf("timestep: %lf | delt: %lf | pressure did not converge in %lf s (setup %lf s, reductions %lf s)\n",
+           solver->t, solver->delt, solver->pressure_time, solver->pressure_setup_time, solver->pressure_reduce_time);
   }
   else {
-    printf("timestep: %lf | delt %lf | convergence in %ld iterations.\n", solver->t, solver->delt, solver->iter);
+    printf("timestep: %lf | delt %lf | convergence in %ld iterations, %lf s (setup %lf s, reductions %lf s).\n",
+           solver->t, solver->delt, solver->iter, solver->pressure_time, solver->pressure_setup_time,
+           solver->pressure_reduce_time);
   }
   printf("Max residual %lf | Convergence reason: %s", solver->resimax, solver->conv_reason_str);
   printf("\n");
@@ -247,6 +338,8 @@ int vof_mpi_output(struct solver_data *solver) {
   printf("max u, v, w: %lf, %lf, %lf\n",solver->umax,solver->vmax,solver->wmax);  
   
   printf("max nu: %lf\n",solver->nu_max);
+  if(solver->viscous_implicit)
+    printf("implicit viscous step: %d sweeps\n", solver->viscous_sweeps);
   
   vof_baffles_output(solver);
   
@@ -260,13 +353,69 @@ int vof_mpi_output(struct solver_data *solver) {
   return 0;
 }
 
+/* whether the explicit viscous limit can be dropped.  k and E still
+ * diffuse explicitly in the turbulence model, by the same viscosity that
+ * sets nu_max, so the limit stays while a model is active */
+static int vof_mpi_viscous_lifted(struct solver_data *solver) {
+  return solver->viscous_implicit && solver->mesh->turbulence_model == NULL;
+}
+
+/* the convective timestep limit of the cells of this rank, and the
+ * explicit viscous one unless it is lifted by the implicit viscous step */
+static double vof_mpi_delt_conv(struct solver_data *solver, double dtvis) {
+  double delt_conv, dt_U, dv;
+  long int i,j,k;
+
+  dv = 0;
+  delt_conv = solver->delt_n * 100;
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(i, j, k, dt_U) reduction(min:delt_conv) schedule(static)
+  for(i=0; i<IRANGE; i++) {
+    for(j=0; j<JMAX; j++) {
+      for(k=0; k<KMAX; k++) {  
+        //dt_U = solver->con * min(1, min(FV(i,j,k),FV(min(IRANGE-1,i+1),j,k)) / AE(i,j,k)) * DELX/(fabs(dv + U(i,j,k)));
+        dt_U = solver->con * 0.5 * (FV(i,j,k) + FV(min(IRANGE-1,i+1),j,k)) / AE(i,j,k) * DELX/(fabs(dv + U(i,j,k)));
+
+        if(AE(i,j,k) > solver->emf && !isnan(dt_U))
+          delt_conv = min(delt_conv, dt_U);
+              
+        //dt_U = solver->con * min(1, min(FV(i,j,k),FV(i,min(JMAX-1,j+1),k)) / AN(i,j,k)) * DELY/(fabs(dv + V(i,j,k)));
+        dt_U = solver->con * 0.5 * (FV(i,j,k) + FV(i,min(JMAX-1,j+1),k)) / AN(i,j,k) * DELY/(fabs(dv + V(i,j,k)));
+
+        if(AN(i,j,k) > solver->emf && !isnan(dt_U))
+          delt_conv = min(delt_conv, dt_U);
+
+        //dt_U = solver->con * min(1, min(FV(i,j,k),FV(i,j,min(KMAX-1,k+1))) / AT(i,j,k)) * DELZ/(fabs(dv + W(i,j,k)));
+        dt_U = solver->con * 0.5 * (FV(i,j,k) + FV(i,j,min(KMAX-1,k+1))) / AT(i,j,k) * DELZ/(fabs(dv + W(i,j,k)));
+
+        if(AT(i,j,k) > solver->emf && !isnan(dt_U))
+          delt_conv = min(delt_conv, dt_U);					
+ #ifdef DEBUG         
+        if(delt_conv < 0.0001) {
+
+          printf("");
+
+        }
+  #endif
+      }
+    }
+  }
+
+  /* the implicit viscous step is stable at any timestep, the limit is
+   * only reported to show what it would have cost */
+  if(!vof_mpi_viscous_lifted(solver)) delt_conv = min(delt_conv, 0.8 * dtvis);
+
+  return delt_conv;
+}
+
 int vof_mpi_deltcal(struct solver_data *solver) {
-  double delt, delt_conv, dt_U, dv;
+  double delt, delt_conv, flags[2];
   int ret = 0;
   double dtvis;
   double mindx;
   long int i,j,k;
   int nan_flag = 0;
+  double umax, vmax, wmax;
   
   #ifdef DEBUG
   long int umax_cell[3], vmax_cell[3], wmax_cell[3];
@@ -283,6 +432,15 @@ int vof_mpi_deltcal(struct solver_data *solver) {
   
   delt = solver->delt_n;
   
+  umax = 0;
+  vmax = 0;
+  wmax = 0;
+
+  /* the DEBUG build tracks the cell holding each maximum, which needs the serial loop */
+#ifndef DEBUG
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(i, j, k) reduction(max:umax, vmax, wmax, nan_flag) schedule(static)
+#endif
   for(i=1; i<IRANGE-1; i++) {
     for(j=1; j<JMAX-1; j++) {
       for(k=1; k<KMAX-1; k++) {        
@@ -296,40 +454,58 @@ int vof_mpi_deltcal(struct solver_data *solver) {
         }
       
 #ifdef DEBUG
-        if(fabs(U(i,j,k)) > solver->umax) {
+        if(fabs(U(i,j,k)) > umax) {
           umax_cell[0]=i; umax_cell[1]=j; umax_cell[2]=k;
         }
-        if(fabs(V(i,j,k)) > solver->vmax) {
+        if(fabs(V(i,j,k)) > vmax) {
           vmax_cell[0]=i; vmax_cell[1]=j; vmax_cell[2]=k;
         }
-        if(fabs(W(i,j,k)) > solver->wmax) {
+        if(fabs(W(i,j,k)) > wmax) {
           wmax_cell[0]=i; wmax_cell[1]=j; wmax_cell[2]=k;
         }        
 #endif
         
-        solver->umax = max(fabs(U(i,j,k)), solver->umax);
-        solver->vmax = max(fabs(V(i,j,k)), solver->vmax);
-        solver->wmax = max(fabs(W(i,j,k)), solver->wmax);
+        umax = max(fabs(U(i,j,k)), umax);
+        vmax = max(fabs(V(i,j,k)), vmax);
+        wmax = max(fabs(W(i,j,k)), wmax);
       }
     }
   }
 
+  solver->umax = umax;
+  solver->vmax = vmax;
+  solver->wmax = wmax;
+
 #ifdef DEBUG
   printf("Max u: %lf in cell %ld %ld %ld\n", solver->umax, umax_cell[0] + ISTART, umax_cell[1], umax_cell[2]);
   printf("Max v: %lf in cell %ld %ld %ld\n", solver->vmax, vmax_cell[0] + ISTART, vmax_cell[1], vmax_cell[2]);
   printf("Max w: %lf in cell %ld %ld %ld\n", solver->wmax, wmax_cell[0] + ISTART, wmax_cell[1], wmax_cell[2]);  
 #endif
 
-  solver->umax = solver_mpi_max(solver,solver->umax);
-  solver->vmax = solver_mpi_max(solver,solver->vmax);
-  solver->wmax = solver_mpi_max(solver,solver->wmax);
+  /* the maxima, the flags and the convective limit are reduced together.
+   * the limit is found before knowing whether the step is rejected, and
+   * again from the restored fields when it is */
+  flags[0] = solver->vof_flag;
+  flags[1] = nan_flag;
+  delt_conv = vof_mpi_delt_conv(solver, dtvis);
+  if(solver_reduce_add(solver, reduce_max, &solver->umax) ||
+     solver_reduce_add(solver, reduce_max, &solver->vmax) ||
+     solver_reduce_add(solver, reduce_max, &solver->wmax) ||
+     solver_reduce_add(solver, reduce_max, &solver->nu_max) ||
+     solver_reduce_add(solver, reduce_max, &flags[0]) ||
+     solver_reduce_add(solver, reduce_max, &flags[1]) ||
+     solver_reduce_add(solver, reduce_min, &delt_conv) ||
+     solver_reduce(solver))
+    return 1;
+  solver->vof_flag = (int) flags[0];
+  nan_flag = (int) flags[1];
 
-  solver->vof_flag = solver_mpi_max(solver, solver->vof_flag);
   if(solver->vof_flag == 1) {
     delt = solver->delt * 0.67;
     ret = 1;
     solver->con *= 0.975;
  
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) private(i, j, k) schedule(static)
     for(i=0; i<IRANGE; i++) {
       for(j=0; j<JMAX; j++) {
         for(k=0; k<KMAX; k++) {
@@ -343,7 +519,8 @@ int vof_mpi_deltcal(struct solver_data *solver) {
         }
       }
     }
-              
+
+    delt_conv = solver_mpi_min(solver, vof_mpi_delt_conv(solver, dtvis));
   }
   
   if(nan_flag == 1) { /* divide by zero error - exit */
@@ -361,6 +538,7 @@ int vof_mpi_deltcal(struct solver_data *solver) {
       }
     }    
     vof_mpi_write_timestep(solver);
+    vof_output_flush();
     PetscEnd();
     exit(1);
   }
@@ -368,47 +546,13 @@ int vof_mpi_deltcal(struct solver_data *solver) {
   if(solver->iter > 150) delt *= 0.975; 
   if(solver->iter < 100) delt *= 1.025; 
 
-  dv = 0;
-  delt_conv = delt * 100;
-  for(i=0; i<IRANGE; i++) {
-    for(j=0; j<JMAX; j++) {
-      for(k=0; k<KMAX; k++) {  
-        //dt_U = solver->con * min(1, min(FV(i,j,k),FV(min(IRANGE-1,i+1),j,k)) / AE(i,j,k)) * DELX/(fabs(dv + U(i,j,k)));
-        dt_U = solver->con * 0.5 * (FV(i,j,k) + FV(min(IRANGE-1,i+1),j,k)) / AE(i,j,k) * DELX/(fabs(dv + U(i,j,k)));
-
-        if(AE(i,j,k) > solver->emf && !isnan(dt_U))
-          delt_conv = min(delt_conv, dt_U);
-              
-        //dt_U = solver->con * min(1, min(FV(i,j,k),FV(i,min(JMAX-1,j+1),k)) / AN(i,j,k)) * DELY/(fabs(dv + V(i,j,k)));
-        dt_U = solver->con * 0.5 * (FV(i,j,k) + FV(i,min(JMAX-1,j+1),k)) / AN(i,j,k) * DELY/(fabs(dv + V(i,j,k)));
-
-        if(AN(i,j,k) > solver->emf && !isnan(dt_U))
-          delt_conv = min(delt_conv, dt_U);
-
-        //dt_U = solver->con * min(1, min(FV(i,j,k),FV(i,j,min(KMAX-1,k+1))) / AT(i,j,k)) * DELZ/(fabs(dv + W(i,j,k)));
-        dt_U = solver->con * 0.5 * (FV(i,j,k) + FV(i,j,min(KMAX-1,k+1))) / AT(i,j,k) * DELZ/(fabs(dv + W(i,j,k)));
-
-        if(AT(i,j,k) > solver->emf && !isnan(dt_U))
-          delt_conv = min(delt_conv, dt_U);					
- #ifdef DEBUG         
-        if(delt_conv < 0.0001) {
-
-          printf("");
-
-        }
-  #endif
-      }
-    }
-  }
-
-  delt_conv = min(delt_conv, 0.8 * dtvis);
-  delt_conv = solver_mpi_min(solver, delt_conv);
   if(!solver->rank) printf("maximum timestep for convective stability: %lf\n",delt_conv);
+  if(!solver->rank && vof_mpi_viscous_lifted(solver) && 0.8 * dtvis < delt_conv)
+    printf("explicit viscous limit of %lf lifted by the implicit viscous step\n", 0.8 * dtvis);
   
+  /* delt_n, iter and the flags agree across the ranks, so delt needs no reduction */
   delt = min(delt, delt_conv);
 
-  delt = solver_mpi_min(solver, delt);
-   
   if(solver->delt_n != delt) {
     if(!solver->rank) printf("timestep adjusted from %lf to %lf\n",solver->delt_n,delt);
 
@@ -432,66 +576,57 @@ int vof_mpi_deltcal(struct solver_data *solver) {
 
 int vof_mpi_write(struct solver_data *solver) {
   static double write_flg = 0;
+  static double checkpoint_flg = -1;
+  double imbalance;
+
+  /* checkpoints keep their own interval, the first one checkpointt in */
+  if(solver->checkpointt > solver->emf) {
+    if(checkpoint_flg < 0) checkpoint_flg = solver->t + solver->checkpointt;
+    else if(solver->t >= checkpoint_flg) {
+      checkpoint_write(solver);
+      checkpoint_flg = solver->t + solver->checkpointt;
+    }
+  }
     
   if(solver->t >= write_flg) {
   
-    vof_mpi_write_timestep(solver);
+    if(!vof_output_full(solver)) vof_mpi_write_timestep(solver);
+    vof_mpi_timer_output(solver);
     
     write_flg = solver->t + solver->writet;
+
+    /* pieces are sized once, so a run that has drifted out of balance
+     * stops at a checkpoint and a restart partitions it again */
+    imbalance = solver_mpi_balance_report(solver);
+    if(solver->balance && !solver->distributed && solver->balance_limit > 0 &&
+       imbalance > solver->balance_limit) {
+      checkpoint_write(solver);
+      if(!solver->rank)
+        printf("load imbalance %.2lf exceeds balance_limit, restart from the checkpoint at %lf to balance it again\n",
+               imbalance, solver->t);
+      vof_mpi_kill_solver(solver);
+    }
   }
 
   return 0;
 }
 
 int vof_mpi_write_timestep(struct solver_data * solver) {
-  int write_step;
-  struct kE_data *kE;
+  int write_step = 0;
   
-  solver_mpi_gather(solver, solver->mesh->P);
-  solver_mpi_gather(solver, solver->mesh->u);
-  solver_mpi_gather(solver, solver->mesh->v);
-  solver_mpi_gather(solver, solver->mesh->w);
-  solver_mpi_gather(solver, solver->mesh->vof);
-  solver_mpi_gather_int(solver, solver->mesh->n_vof);
-
-  if(solver->mesh->turbulence_model != NULL) {
-    kE = solver->mesh->turbulence_model;
-    solver_mpi_gather(solver, kE->k);
-    solver_mpi_gather(solver, kE->E);
-  }
-
+  /* every rank writes its own piece in parallel, rank 0 adds the .pvti 
+   * masters.  a single process writes the whole mesh as before.  the files
+   * themselves are written in the background by vof_output */
   if(!solver->rank) {
     write_step = track_add(solver->t);
     track_write();
-
-    vtk_write_P(solver->mesh,write_step);
-    vtk_write_U(solver->mesh,write_step);
-    vtk_write_vof(solver->mesh,write_step);
-    
-    csv_write_P(solver->mesh,solver->t);
-    csv_write_U(solver->mesh,solver->t);
-    csv_write_vof(solver->mesh,solver->t);
-    csv_write_n_vof(solver->mesh,solver->t);
-    
-    if(solver->mesh->turbulence_model != NULL) {
-      vtk_write_k(solver->mesh,write_step);
-      vtk_write_E(solver->mesh,write_step);
-      csv_write_k(solver->mesh,solver->t);
-      csv_write_E(solver->mesh,solver->t);
-    }
   }
+  if(solver->size > 1) MPI_Bcast(&write_step, 1, MPI_INT, 0, MPI_COMM_WORLD);
 
   vof_baffles_write(solver);
-  
-  vof_vorticity(solver);/*
-  solver_mpi_gather(solver, solver->mesh->u_omega);
-  solver_mpi_gather(solver, solver->mesh->v_omega);
-  solver_mpi_gather(solver, solver->mesh->w_omega);*/
-  
-  if(!solver->rank) {
-    vtk_write_vorticity(solver->mesh,write_step);
-    csv_write_vorticity(solver->mesh,solver->t);
-  }
+  vof_vorticity(solver);
+
+  vof_output_write(solver, write_step);
   
   return 1;
 }
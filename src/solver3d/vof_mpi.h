@@ -19,12 +19,16 @@ int vof_special_boundaries(struct solver_data *solver);
 int vof_mpi_pressure(struct solver_data *solver);
 int vof_mpi_velocity_upwind(struct solver_data *solver);
 int vof_mpi_convect(struct solver_data *solver);
+int vof_convect_planes(struct solver_data *solver, long int ibegin, long int iend, 
+                       int lead_in, int lead_out);
 int vof_mpi_hydrostatic(struct solver_data *solver);
 int vof_mpi_nvof(struct solver_data *solver);
 int vof_mpi_deltcal(struct solver_data *solver);
 int vof_mpi_write(struct solver_data *solver);
 int vof_mpi_write_timestep(struct solver_data * solver);
 int vof_mpi_output(struct solver_data *solver);
+void vof_mpi_timer(struct solver_data *solver, enum solver_timers timer, double t_start);
+int vof_mpi_timer_output(struct solver_data *solver);
 int vof_mpi_setup_solver(struct solver_data *solver);
 int vof_mpi_kill_solver(struct solver_data *solver);
 int vof_mpi_pressure_test(struct solver_data *solver);
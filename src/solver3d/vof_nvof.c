@@ -95,6 +95,17 @@ int vof_mpi_nvof(struct solver_data *solver) {
                         { 0.7, 0.9, 0.7 } };
   double top_score = 0;
   double lvof[6];
+  long int c, cn;
+
+  const struct mesh_view view = mesh_view(solver->mesh, solver->mesh->vof);
+  const long int off[6] = { view.si, -view.si, view.sj, -view.sj, 1, -1 };
+  enum cell_boundaries * const n_vof = solver->mesh->n_vof;
+  const double * const vof = solver->mesh->vof;
+  const double * const fv = solver->mesh->fv;
+  const double * const ae = solver->mesh->ae;
+  const double * const an = solver->mesh->an;
+  const double * const at = solver->mesh->at;
+  const long int irange = IRANGE, jmax = JMAX, kmax = KMAX;
 
 #define emf solver->emf
 #define emf_c solver->emf_c
@@ -106,29 +117,33 @@ int vof_mpi_nvof(struct solver_data *solver) {
   g[4] = solver->gz;
   g[5] = solver->gz * -1;
 
-  for(i=1; i<IRANGE-1; i++) {
-    for(j=0; j<JMAX; j++) {
-      for(k=0; k<KMAX; k++) {
-        N_VOF(i,j,k) = none;
-        if(j==0 || k==0 || j==JMAX-1 || k==KMAX-1 || FV(i,j,k) == 0)
-          N_VOF(i,j,k) = 0;
-        else if(VOF(i+1,j,k) >= emf && VOF(i,j+1,k) >= emf 
-          && VOF(i-1,j,k) >= emf && VOF(i,j-1,k) >= emf
-          && VOF(i,j,k+1) >= emf && VOF(i,j,k-1) >= emf) {
-          N_VOF(i,j,k) = 0;          
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(i, j, k, c) schedule(static)
+  for(i=1; i<irange-1; i++) {
+    for(j=0; j<jmax; j++) {
+      for(k=0; k<kmax; k++) {
+        c = MESH_VIEW_OFFSET(view, i, j, k);
+
+        n_vof[c] = none;
+        if(j==0 || k==0 || j==jmax-1 || k==kmax-1 || fv[c] == 0)
+          n_vof[c] = 0;
+        else if(vof[c+view.si] >= emf && vof[c+view.sj] >= emf 
+          && vof[c-view.si] >= emf && vof[c-view.sj] >= emf
+          && vof[c+1] >= emf && vof[c-1] >= emf) {
+          n_vof[c] = 0;          
         }
       }
     }
   }
 
-  if(ISTART ==0) {
+  if(solver_mpi_wall(solver, 0)) {
     for(j=1; j<JMAX-1; j++) {
       for(k=1; k<KMAX-1; k++) {
         N_VOF(0,j,k) = 0;
       }
     }
   }
-  if(IRANGE+ISTART == IMAX) {
+  if(solver_mpi_wall(solver, 1)) {
     for(j=1; j<JMAX-1; j++) {
       for(k=1; k<KMAX-1; k++) {
         N_VOF(IRANGE-1,j,k) = 0;
@@ -136,22 +151,25 @@ int vof_mpi_nvof(struct solver_data *solver) {
     }
   }
  
-  for(i=1; i<IRANGE-1; i++) {
-    for(j=1; j<JMAX-1; j++) {
-      for(k=1; k<KMAX-1; k++) {
-
-        if(FV(i,j,k) == 0) {
-          N_VOF(i,j,k) = 0;
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(i, j, k, c, cn, l, m, n, x, obs, score, lvof, top_score) schedule(dynamic, 4)
+  for(i=1; i<irange-1; i++) {
+    for(j=1; j<jmax-1; j++) {
+      for(k=1; k<kmax-1; k++) {
+        c = MESH_VIEW_OFFSET(view, i, j, k);
+
+        if(fv[c] == 0) {
+          n_vof[c] = 0;
           continue;
         }
 
-        if(VOF(i,j,k) < emf) {
-          N_VOF(i,j,k) = 8; 
+        if(vof[c] < emf) {
+          n_vof[c] = 8; 
           continue;
         }
   
-        if(VOF(i,j,k) > emf_c) {
-          N_VOF(i,j,k) = 0;
+        if(vof[c] > emf_c) {
+          n_vof[c] = 0;
           continue;
         }
 
@@ -159,42 +177,43 @@ int vof_mpi_nvof(struct solver_data *solver) {
         /* iterate on all sides and check if we are bounded by either an obstacle or fluid for all cells, if so NVOF=0 */
         obs = 0;
         for(n=0; n<6; n++) {
-          lvof[n] = VOF(i,j,k);
+          lvof[n] = vof[c];
           score[n] = 0;
+          cn = c + off[n];
 
           switch(n) {
           case 0:
-            if (AE(i,j,k) >emf) lvof[n] = VOF(i+norm[n][0], j+norm[n][1], k+norm[n][2]);
+            if (ae[c] >emf) lvof[n] = vof[cn];
             break; 
           case 1:
-            if (AE(i-1,j,k) >emf) lvof[n] = VOF(i+norm[n][0], j+norm[n][1], k+norm[n][2]);
+            if (ae[cn] >emf) lvof[n] = vof[cn];
             break; 
           case 2:
-            if (AN(i,j,k) >emf) lvof[n] = VOF(i+norm[n][0], j+norm[n][1], k+norm[n][2]);
+            if (an[c] >emf) lvof[n] = vof[cn];
             break; 
           case 3:
-            if (AN(i,j-1,k) >emf) lvof[n] = VOF(i+norm[n][0], j+norm[n][1], k+norm[n][2]);
+            if (an[cn] >emf) lvof[n] = vof[cn];
             break; 
           case 4:
-            if (AT(i,j,k) >emf) lvof[n] = VOF(i+norm[n][0], j+norm[n][1], k+norm[n][2]);
+            if (at[c] >emf) lvof[n] = vof[cn];
             break; 
           case 5:
-            if (AT(i,j,k-1) >emf) lvof[n] = VOF(i+norm[n][0], j+norm[n][1], k+norm[n][2]);
+            if (at[cn] >emf) lvof[n] = vof[cn];
             break; 
           default:
             continue;
           }
           
-          if(FV(i+norm[n][0], j+norm[n][1], k+norm[n][2]) < emf && g[n] < emf) {
+          if(fv[cn] < emf && g[n] < emf) {
             obs++;
           }
           else if(lvof[n] > emf) {
             obs++;
           }
         }
-        if(obs == n) N_VOF(i,j,k) = 0;
+        if(obs == n) n_vof[c] = 0;
 
-        if(N_VOF(i,j,k) == 0) continue;
+        if(n_vof[c] == 0) continue;
 
         top_score = emf;
         for(x=0; x<6; x++) {
@@ -203,42 +222,29 @@ int vof_mpi_nvof(struct solver_data *solver) {
           if(x < 2) {
             for(m=-1; m<=1; m++) {
               for(n=-1; n<=1; n++) {
-                score[x] += VOF(l+i,m+j,n+k) * mult[m+1][n+1];
-              }
-            }
-
-            if(score[x] > top_score && lvof[x] > emf) { 
-              if(FV(i+norm[x][0], j+norm[x][1], k+norm[x][2]) > emf || g[x] > emf) {
-                N_VOF(i,j,k) = x+1;
-                top_score = score[x];
+                score[x] += vof[c + l * view.si + m * view.sj + n] * mult[m+1][n+1];
               }
             }
           }
           else if(x < 4) {
             for(l=-1; l<=1; l++) {
               for(n=-1; n<=1; n++) {
-                score[x] += VOF(l+i,m+j,n+k)  * mult[l+1][n+1];
-              }
-            }
-
-            if(score[x] > top_score && lvof[x] > emf) { 
-              if(FV(i+norm[x][0], j+norm[x][1], k+norm[x][2]) > emf || g[x] > emf) {
-                N_VOF(i,j,k) = x+1;
-                top_score = score[x];
+                score[x] += vof[c + l * view.si + m * view.sj + n]  * mult[l+1][n+1];
               }
             }
           }
           else {
             for(l=-1; l<=1; l++) {
               for(m=-1; m<=1; m++) {
-                score[x] += VOF(l+i,m+j,n+k)  * mult[l+1][m+1];
+                score[x] += vof[c + l * view.si + m * view.sj + n]  * mult[l+1][m+1];
               }
             }
-            if(score[x] > top_score && lvof[x] > emf) { 
-              if(FV(i+norm[x][0], j+norm[x][1], k+norm[x][2]) > emf || g[x] > emf) {
-                N_VOF(i,j,k) = x+1;
-                top_score = score[x];
-              }
+          }
+
+          if(score[x] > top_score && lvof[x] > emf) { 
+            if(fv[c + off[x]] > emf || g[x] > emf) {
+              n_vof[c] = x+1;
+              top_score = score[x];
             }
           }
 
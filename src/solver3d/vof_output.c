@@ -0,0 +1,284 @@
+/* vof_output.c
+ *
+ * writes the results of a timestep.  the fields are copied into a snapshot
+ * and handed to a writer thread, so compressing and writing the files
+ * overlaps the following timesteps.  at most output_buffers snapshots exist
+ * at once
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <mpi.h>
+
+#include "vtk.h"
+#include "vtk_xml.h"
+#include "csv.h"
+#include "kE.h"
+#include "mesh.h"
+#include "solver.h"
+#include "solver_mpi.h"
+#include "vof_output.h"
+
+struct vof_output_snapshot {
+  struct mesh_data mesh; /* copy of the mesh header, the fields point into data */
+  struct kE_data kE;
+  double t;
+  int write_step;
+  int masters; /* rank 0 of a parallel run also writes the .pvti masters */
+  long int *piece_start, *piece_range;
+
+  double *data;
+  enum cell_boundaries *n_vof;
+
+  struct vof_output_snapshot *next;
+};
+
+static pthread_t output_thread;
+static pthread_mutex_t output_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t output_ready = PTHREAD_COND_INITIALIZER; /* a snapshot is queued */
+static pthread_cond_t output_done = PTHREAD_COND_INITIALIZER;  /* a snapshot is free again */
+
+static struct vof_output_snapshot *output_queue = NULL, *output_free = NULL;
+static int output_allocated = 0, output_running = 0, output_stopping = 0;
+
+static void vof_output_files(struct vof_output_snapshot *snap) {
+  struct mesh_data *mesh = &snap->mesh;
+
+  vtk_write_P(mesh, snap->write_step);
+  vtk_write_U(mesh, snap->write_step);
+  vtk_write_vof(mesh, snap->write_step);
+  vtk_write_vorticity(mesh, snap->write_step);
+
+  csv_write_P(mesh, snap->t);
+  csv_write_U(mesh, snap->t);
+  csv_write_vof(mesh, snap->t);
+  csv_write_n_vof(mesh, snap->t);
+  csv_write_vorticity(mesh, snap->t);
+
+  if(mesh->turbulence_model != NULL) {
+    vtk_write_k(mesh, snap->write_step);
+    vtk_write_E(mesh, snap->write_step);
+    csv_write_k(mesh, snap->t);
+    csv_write_E(mesh, snap->t);
+  }
+
+  if(!snap->masters) return;
+
+  vtk_write_pvti(mesh, "P", snap->write_step, 0, 1, snap->piece_start, snap->piece_range);
+  vtk_write_pvti(mesh, "U", snap->write_step, 1, 1, snap->piece_start, snap->piece_range);
+  vtk_write_pvti(mesh, "vof", snap->write_step, 0, 0, snap->piece_start, snap->piece_range);
+  vtk_write_pvti(mesh, "vorticity", snap->write_step, 1, 1, snap->piece_start, snap->piece_range);
+  if(mesh->turbulence_model != NULL) {
+    vtk_write_pvti(mesh, "k", snap->write_step, 0, 1, snap->piece_start, snap->piece_range);
+    vtk_write_pvti(mesh, "E", snap->write_step, 0, 1, snap->piece_start, snap->piece_range);
+  }
+}
+
+static void *vof_output_thread(void *arg) {
+  struct vof_output_snapshot *snap;
+
+  (void) arg; /* the queue is shared through the statics above */
+
+  pthread_mutex_lock(&output_lock);
+  for(;;) {
+    while(output_queue == NULL && !output_stopping)
+      pthread_cond_wait(&output_ready, &output_lock);
+    if(output_queue == NULL) break;
+
+    snap = output_queue;
+    output_queue = snap->next;
+    pthread_mutex_unlock(&output_lock);
+
+    vof_output_files(snap);
+
+    pthread_mutex_lock(&output_lock);
+    snap->next = output_free;
+    output_free = snap;
+    pthread_cond_signal(&output_done);
+  }
+  pthread_mutex_unlock(&output_lock);
+
+  return NULL;
+}
+
+/* fills the header of a snapshot from the solver.  the fields are those of
+ * the live mesh until vof_output_copy replaces them */
+static void vof_output_header(struct solver_data *solver, struct vof_output_snapshot *snap,
+                              int write_step) {
+  snap->mesh = *solver->mesh;
+  if(solver->mesh->turbulence_model != NULL) {
+    snap->kE = *((struct kE_data *) solver->mesh->turbulence_model);
+    snap->mesh.turbulence_model = &snap->kE;
+  }
+  snap->t = solver->t;
+  snap->write_step = write_step;
+  snap->masters = (!solver->rank && solver->mesh->piece >= 0);
+  snap->piece_start = solver->piece_start;
+  snap->piece_range = solver->piece_range;
+}
+
+static long int vof_output_cells(struct mesh_data *mesh) {
+  if(mesh->piece < 0) return mesh->imax * mesh->jmax * mesh->kmax;
+  return mesh->i_range * mesh->jmax * mesh->kmax;
+}
+
+static struct vof_output_snapshot *vof_output_alloc(struct solver_data *solver) {
+  struct vof_output_snapshot *snap;
+  long int cells = vof_output_cells(solver->mesh);
+
+  snap = malloc(sizeof(struct vof_output_snapshot));
+  if(snap == NULL) return NULL;
+
+  /* P, u, v, w, vof, the vorticity and k and E */
+  snap->data = malloc(sizeof(double) * cells * 10);
+  snap->n_vof = malloc(sizeof(enum cell_boundaries) * cells);
+  if(snap->data == NULL || snap->n_vof == NULL) {
+    free(snap->data);
+    free(snap->n_vof);
+    free(snap);
+    return NULL;
+  }
+  snap->next = NULL;
+
+  return snap;
+}
+
+static void vof_output_copy(struct solver_data *solver, struct vof_output_snapshot *snap) {
+  long int cells = vof_output_cells(solver->mesh);
+  double **fields[10];
+  int n, count = 0;
+
+  fields[count++] = &snap->mesh.P;
+  fields[count++] = &snap->mesh.u;
+  fields[count++] = &snap->mesh.v;
+  fields[count++] = &snap->mesh.w;
+  fields[count++] = &snap->mesh.vof;
+  fields[count++] = &snap->mesh.u_omega;
+  fields[count++] = &snap->mesh.v_omega;
+  fields[count++] = &snap->mesh.w_omega;
+  if(solver->mesh->turbulence_model != NULL) {
+    fields[count++] = &snap->kE.k;
+    fields[count++] = &snap->kE.E;
+  }
+
+  /* the header still points at the live fields, copy and repoint them */
+  for(n = 0; n < count; n++) {
+    memcpy(snap->data + n * cells, *fields[n], sizeof(double) * cells);
+    *fields[n] = snap->data + n * cells;
+  }
+
+  memcpy(snap->n_vof, solver->mesh->n_vof, sizeof(enum cell_boundaries) * cells);
+  snap->mesh.n_vof = snap->n_vof;
+}
+
+int vof_output_init(struct solver_data *solver) {
+  vtk_xml_set_format(solver->vtk_compression, solver->vtk_raw, solver->vtk_float32, solver->threads);
+
+  if(solver->output_buffers < 1 || output_running) return 0;
+
+  output_stopping = 0;
+  if(pthread_create(&output_thread, NULL, vof_output_thread, NULL)) {
+    printf("warning: could not start the output thread, writing in the timestep loop\n");
+    solver->output_buffers = 0;
+    return 0;
+  }
+  output_running = 1;
+
+  return 0;
+}
+
+/* with output_drop set, whether a periodic output should be skipped as
+ * every buffer is still queued.  agreed across ranks so the pieces stay whole */
+int vof_output_full(struct solver_data *solver) {
+  double full;
+
+  if(!output_running || !solver->output_drop) return 0;
+
+  pthread_mutex_lock(&output_lock);
+  full = (output_free == NULL && output_allocated >= solver->output_buffers);
+  pthread_mutex_unlock(&output_lock);
+
+  if(solver_mpi_max(solver, full) > 0) {
+    if(!solver->rank) printf("output buffers full, skipping output at t = %lf\n", solver->t);
+    return 1;
+  }
+
+  return 0;
+}
+
+/* writes the fields of the current timestep as output write_step.  with
+ * output buffers they are snapshot and written in the background, waiting
+ * for a buffer if they are all queued */
+int vof_output_write(struct solver_data *solver, int write_step) {
+  struct vof_output_snapshot *snap, live, **tail;
+
+  if(!output_running) {
+    vof_output_header(solver, &live, write_step);
+    vof_output_files(&live);
+    return 0;
+  }
+
+  pthread_mutex_lock(&output_lock);
+  if(output_free == NULL && output_allocated < solver->output_buffers) {
+    snap = vof_output_alloc(solver);
+    if(snap != NULL) {
+      output_allocated++;
+      snap->next = output_free;
+      output_free = snap;
+    }
+  }
+  while(output_free == NULL) {
+    if(output_allocated == 0) {
+      /* nothing could be allocated, write in the timestep loop instead */
+      pthread_mutex_unlock(&output_lock);
+      printf("warning: could not allocate output buffers, writing in the timestep loop\n");
+      vof_output_header(solver, &live, write_step);
+      vof_output_files(&live);
+      return 0;
+    }
+    pthread_cond_wait(&output_done, &output_lock);
+  }
+  snap = output_free;
+  output_free = snap->next;
+  pthread_mutex_unlock(&output_lock);
+
+  vof_output_header(solver, snap, write_step);
+  vof_output_copy(solver, snap);
+  snap->next = NULL;
+
+  pthread_mutex_lock(&output_lock);
+  for(tail = &output_queue; *tail != NULL; tail = &(*tail)->next);
+  *tail = snap;
+  pthread_cond_signal(&output_ready);
+  pthread_mutex_unlock(&output_lock);
+
+  return 0;
+}
+
+/* waits for every queued output to be written, then stops the writer */
+int vof_output_flush() {
+  struct vof_output_snapshot *snap;
+
+  if(!output_running) return 0;
+
+  pthread_mutex_lock(&output_lock);
+  output_stopping = 1;
+  pthread_cond_signal(&output_ready);
+  pthread_mutex_unlock(&output_lock);
+
+  pthread_join(output_thread, NULL);
+  output_running = 0;
+
+  while(output_free != NULL) {
+    snap = output_free;
+    output_free = snap->next;
+    free(snap->data);
+    free(snap->n_vof);
+    free(snap);
+  }
+  output_allocated = 0;
+
+  return 0;
+}
@@ -0,0 +1,16 @@
+/* vof_output.h
+ *
+ * writes the results of a timestep, in the background if buffers allow
+ */
+
+#ifndef VOF_OUTPUT_H
+#define VOF_OUTPUT_H
+
+#include "solver_data.h"
+
+int vof_output_init(struct solver_data *solver);
+int vof_output_full(struct solver_data *solver);
+int vof_output_write(struct solver_data *solver, int write_step);
+int vof_output_flush();
+
+#endif
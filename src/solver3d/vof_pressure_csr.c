@@ -0,0 +1,306 @@
+/* vof_pressure_csr.c
+ *
+ * the pressure matrix holds the full 7-point pattern of every owned row,
+ * built once from a CSR layout.  the pattern never changes, so values are
+ * written straight into the diagonal and off-diagonal blocks at an offset
+ * worked out from the row's position in the mesh, without global index
+ * lookups or assembly
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <petscmat.h>
+
+#include "solver.h"
+#include "mesh.h"
+#include "solver_mpi.h"
+#include "vof_pressure_csr.h"
+
+#include "vof_macros.h"
+
+struct vof_pressure_csr {
+  struct solver_data *solver;
+  long int rows;
+  PetscInt row_start, row_end; /* owned rows, which are also the columns of the diagonal block */
+  PetscInt *start_d, *start_o; /* first entry of each row in the diagonal and off-diagonal blocks */
+  Mat Ad, Ao;
+  PetscScalar *va, *vo;        /* values of the blocks while a write is open */
+};
+
+static struct vof_pressure_csr csr;
+
+/* neighbours numbered as in row_idx of the assembly, and the order their
+ * columns appear in a row */
+static const int csr_order[7] = { 2, 4, 6, 0, 5, 3, 1 };
+
+static long int vof_pressure_csr_step(struct solver_data *solver, int d) {
+  const long int step[7] = { 0, JMAX * KMAX, -JMAX * KMAX, KMAX, -KMAX, 1, -1 };
+
+  return step[d];
+}
+
+/* whether neighbour d of global row lies inside the mesh */
+static int vof_pressure_csr_present(struct solver_data *solver, PetscInt row, int d) {
+  long int i, j, k;
+
+  k = row % KMAX;
+  j = (row / KMAX) % JMAX;
+  i = row / (JMAX * KMAX);
+
+  switch(d) {
+  case 1:
+    return i + 1 < IMAX;
+  case 2:
+    return i > 0;
+  case 3:
+    return j + 1 < JMAX;
+  case 4:
+    return j > 0;
+  case 5:
+    return k + 1 < KMAX;
+  case 6:
+    return k > 0;
+  }
+
+  return 1;
+}
+
+static int vof_pressure_csr_local(PetscInt col) {
+  return col >= csr.row_start && col < csr.row_end;
+}
+
+/* creates the matrix over the planes owned by this process with every
+ * entry of the pattern zero */
+int vof_pressure_csr_create(struct solver_data *solver, long int planes, Mat *A) {
+  const PetscInt *ia, *ja;
+  PetscInt *rows_i, *cols, m, nd, no;
+  PetscScalar *values;
+  PetscBool done;
+  PetscErrorCode ierr;
+  long int n, size;
+  PetscInt row, col, start, end;
+  int o, failed = 0;
+
+  csr.solver = solver;
+  csr.rows = planes * JMAX * KMAX;
+  csr.row_start = (ISTART + (solver_mpi_wall(solver, 0) ? 0 : 1)) * JMAX * KMAX;
+  csr.row_end = csr.row_start + csr.rows;
+  size = IMAX * JMAX * KMAX;
+
+  rows_i = malloc(sizeof(PetscInt) * (csr.rows + 1));
+  cols = malloc(sizeof(PetscInt) * csr.rows * 7);
+  values = calloc(csr.rows * 7, sizeof(PetscScalar));
+  csr.start_d = malloc(sizeof(PetscInt) * (csr.rows + 1));
+  csr.start_o = malloc(sizeof(PetscInt) * (csr.rows + 1));
+  if(rows_i == NULL || cols == NULL || values == NULL || csr.start_d == NULL || csr.start_o == NULL) {
+    printf("error: could not allocate the pressure matrix layout\n");
+    free(rows_i);
+    free(cols);
+    free(values);
+    free(csr.start_d);
+    free(csr.start_o);
+    return 1;
+  }
+
+  rows_i[0] = 0;
+  nd = 0;
+  no = 0;
+  for(n = 0; n < csr.rows; n++) {
+    row = csr.row_start + n;
+    csr.start_d[n] = nd;
+    csr.start_o[n] = no;
+    rows_i[n + 1] = rows_i[n];
+
+    for(o = 0; o < 7; o++) {
+      if(!vof_pressure_csr_present(solver, row, csr_order[o])) continue;
+
+      col = row + vof_pressure_csr_step(solver, csr_order[o]);
+      cols[rows_i[n + 1]++] = col;
+      if(vof_pressure_csr_local(col)) nd++;
+      else no++;
+    }
+  }
+  csr.start_d[csr.rows] = nd;
+  csr.start_o[csr.rows] = no;
+
+  ierr = MatCreateMPIAIJWithArrays(PETSC_COMM_WORLD, csr.rows, csr.rows, size, size,
+                                   rows_i, cols, values, A);CHKERRQ(ierr);
+  free(rows_i);
+  free(cols);
+  free(values);
+
+  ierr = MatMPIAIJGetSeqAIJ(*A, &csr.Ad, &csr.Ao, NULL);CHKERRQ(ierr);
+
+  /* rows zeroed for the symmetric form keep their entries */
+  ierr = MatSetOption(*A, MAT_KEEP_NONZERO_PATTERN, PETSC_TRUE);CHKERRQ(ierr);
+
+  /* the offsets assume petsc kept every entry in column order, with the
+   * rows owned as the planes are */
+  ierr = MatGetOwnershipRange(*A, &start, &end);CHKERRQ(ierr);
+  if(start != csr.row_start || end != csr.row_end) failed = 1;
+
+  ierr = MatGetRowIJ(csr.Ad, 0, PETSC_FALSE, PETSC_FALSE, &m, &ia, &ja, &done);CHKERRQ(ierr);
+  for(n = 0; n <= csr.rows && done; n++)
+    if(ia[n] != csr.start_d[n]) failed = 1;
+  ierr = MatRestoreRowIJ(csr.Ad, 0, PETSC_FALSE, PETSC_FALSE, &m, &ia, &ja, &done);CHKERRQ(ierr);
+
+  ierr = MatGetRowIJ(csr.Ao, 0, PETSC_FALSE, PETSC_FALSE, &m, &ia, &ja, &done);CHKERRQ(ierr);
+  for(n = 0; n <= csr.rows && done; n++)
+    if(ia[n] != csr.start_o[n]) failed = 1;
+  ierr = MatRestoreRowIJ(csr.Ao, 0, PETSC_FALSE, PETSC_FALSE, &m, &ia, &ja, &done);CHKERRQ(ierr);
+
+  if(failed) {
+    printf("error: pressure matrix does not match its layout on proc %d\n", solver->rank);
+    return 1;
+  }
+
+  return 0;
+}
+
+/* opens the values of the matrix for vof_pressure_csr_set */
+int vof_pressure_csr_begin(Mat A) {
+  PetscErrorCode ierr;
+
+  ierr = MatMPIAIJGetSeqAIJ(A, &csr.Ad, &csr.Ao, NULL);CHKERRQ(ierr);
+  ierr = MatSeqAIJGetArray(csr.Ad, &csr.va);CHKERRQ(ierr);
+  ierr = MatSeqAIJGetArray(csr.Ao, &csr.vo);CHKERRQ(ierr);
+
+  return 0;
+}
+
+/* position of neighbour d of owned row n in the values of its block,
+ * counting the entries of the same block ahead of it in the row */
+static long int vof_pressure_csr_slot(struct solver_data *solver, long int n, int d, int *local) {
+  PetscInt row = csr.row_start + n;
+  long int pos = 0;
+  int o, e;
+
+  *local = vof_pressure_csr_local(row + vof_pressure_csr_step(solver, d));
+  for(o = 0; o < 7; o++) {
+    e = csr_order[o];
+    if(e == d) break;
+    if(!vof_pressure_csr_present(solver, row, e)) continue;
+    if(vof_pressure_csr_local(row + vof_pressure_csr_step(solver, e)) == *local) pos++;
+  }
+
+  return (*local ? csr.start_d[n] : csr.start_o[n]) + pos;
+}
+
+/* the equivalent of MatSetValue with INSERT_VALUES.  rows of other
+ * processes are ignored, as with MAT_IGNORE_OFF_PROC_ENTRIES */
+int vof_pressure_csr_set(PetscInt row, PetscInt col, PetscScalar value) {
+  struct solver_data *solver = csr.solver;
+  long int n, pos;
+  int d, local;
+
+  n = row - csr.row_start;
+  if(n < 0 || n >= csr.rows) return 0;
+
+  for(d = 0; d < 7; d++)
+    if(col - row == vof_pressure_csr_step(solver, d)) break;
+  if(d == 7 || !vof_pressure_csr_present(solver, row, d)) {
+    printf("error: column %ld is outside the pressure stencil of row %ld\n", (long int) col, (long int) row);
+    return 1;
+  }
+
+  pos = vof_pressure_csr_slot(solver, n, d, &local);
+  if(local) csr.va[pos] = value;
+  else csr.vo[pos] = value;
+
+  return 0;
+}
+
+/* the value of an entry of an owned row, read while the values are open */
+PetscScalar vof_pressure_csr_get(PetscInt row, PetscInt col) {
+  struct solver_data *solver = csr.solver;
+  long int n, pos;
+  int d, local;
+
+  n = row - csr.row_start;
+  if(n < 0 || n >= csr.rows) return 0;
+
+  for(d = 0; d < 7; d++)
+    if(col - row == vof_pressure_csr_step(solver, d)) break;
+  if(d == 7 || !vof_pressure_csr_present(solver, row, d)) return 0;
+
+  pos = vof_pressure_csr_slot(solver, n, d, &local);
+
+  return local ? csr.va[pos] : csr.vo[pos];
+}
+
+/* closes the values and marks the matrix changed, so the preconditioner
+ * is rebuilt as it would be after an assembly */
+int vof_pressure_csr_end(Mat A) {
+  PetscErrorCode ierr;
+
+  ierr = MatSeqAIJRestoreArray(csr.Ad, &csr.va);CHKERRQ(ierr);
+  ierr = MatSeqAIJRestoreArray(csr.Ao, &csr.vo);CHKERRQ(ierr);
+  ierr = PetscObjectStateIncrease((PetscObject) A);CHKERRQ(ierr);
+
+  return 0;
+}
+
+/* flags the owned rows that hold nothing but a diagonal of 1 or -1 */
+int vof_pressure_csr_identity(char *identity) {
+  struct solver_data *solver = csr.solver;
+  const PetscScalar *va, *vo;
+  PetscErrorCode ierr;
+  long int n, e, diag;
+  int local;
+
+  ierr = MatSeqAIJGetArrayRead(csr.Ad, &va);CHKERRQ(ierr);
+  ierr = MatSeqAIJGetArrayRead(csr.Ao, &vo);CHKERRQ(ierr);
+
+  for(n = 0; n < csr.rows; n++) {
+    diag = vof_pressure_csr_slot(solver, n, 0, &local);
+    identity[n] = (va[diag] == 1 || va[diag] == -1);
+
+    for(e = csr.start_d[n]; e < csr.start_d[n + 1] && identity[n]; e++)
+      if(e != diag && va[e] != 0) identity[n] = 0;
+    for(e = csr.start_o[n]; e < csr.start_o[n + 1] && identity[n]; e++)
+      if(vo[e] != 0) identity[n] = 0;
+  }
+
+  ierr = MatSeqAIJRestoreArrayRead(csr.Ad, &va);CHKERRQ(ierr);
+  ierr = MatSeqAIJRestoreArrayRead(csr.Ao, &vo);CHKERRQ(ierr);
+
+  return 0;
+}
+
+/* the coefficients along the k-line of each owned row, and to the rows of
+ * the next and previous j-lines of the same plane */
+int vof_pressure_csr_lines(double *lower, double *diag, double *upper, double *south, double *north) {
+  struct solver_data *solver = csr.solver;
+  const PetscScalar *va, *vo;
+  double *coef[7] = { NULL };
+  PetscErrorCode ierr;
+  PetscInt row;
+  long int n, pos;
+  int d, local;
+
+  coef[0] = diag;
+  coef[3] = north;
+  coef[4] = south;
+  coef[5] = upper;
+  coef[6] = lower;
+
+  ierr = MatSeqAIJGetArrayRead(csr.Ad, &va);CHKERRQ(ierr);
+  ierr = MatSeqAIJGetArrayRead(csr.Ao, &vo);CHKERRQ(ierr);
+
+  for(n = 0; n < csr.rows; n++) {
+    row = csr.row_start + n;
+    for(d = 0; d < 7; d++) {
+      if(coef[d] == NULL) continue;
+      coef[d][n] = 0;
+      if(!vof_pressure_csr_present(solver, row, d)) continue;
+
+      pos = vof_pressure_csr_slot(solver, n, d, &local);
+      coef[d][n] = local ? va[pos] : vo[pos];
+    }
+  }
+
+  ierr = MatSeqAIJRestoreArrayRead(csr.Ad, &va);CHKERRQ(ierr);
+  ierr = MatSeqAIJRestoreArrayRead(csr.Ao, &vo);CHKERRQ(ierr);
+
+  return 0;
+}
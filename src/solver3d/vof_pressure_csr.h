@@ -0,0 +1,20 @@
+/* vof_pressure_csr.h
+ *
+ * pressure matrix assembled once from a fixed CSR layout
+ */
+
+#ifndef VOF_PRESSURE_CSR_H
+#define VOF_PRESSURE_CSR_H
+
+#include <petscmat.h>
+#include "solver_data.h"
+
+int vof_pressure_csr_create(struct solver_data *solver, long int planes, Mat *A);
+int vof_pressure_csr_begin(Mat A);
+int vof_pressure_csr_set(PetscInt row, PetscInt col, PetscScalar value);
+PetscScalar vof_pressure_csr_get(PetscInt row, PetscInt col);
+int vof_pressure_csr_end(Mat A);
+int vof_pressure_csr_identity(char *identity);
+int vof_pressure_csr_lines(double *lower, double *diag, double *upper, double *south, double *north);
+
+#endif
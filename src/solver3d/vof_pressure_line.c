@@ -0,0 +1,232 @@
+/* vof_pressure_line.c
+ *
+ * plane-local relaxation for the pressure solve.  each (i, j) column is
+ * KMAX contiguous rows, coupled along k through the AT fractional areas.
+ * the vertical lines solve every column exactly as a tridiagonal system,
+ * line jacobi treating the columns on their own and symmetric line
+ * gauss-seidel sweeping them forward and back along j within each plane.
+ * the points do the point symmetric gauss-seidel of the block jacobi.
+ * with pressure_pc_single the coefficients are applied as float
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include <petscksp.h>
+
+#include "solver.h"
+#include "mesh.h"
+#include "vof_pressure_shell.h"
+#include "vof_pressure_csr.h"
+#include "vof_pressure_line.h"
+
+#include "vof_macros.h"
+
+#define LINE_REAL double
+#define LINE_NAME(name) vof_pressure_line_##name##_d
+#include "vof_pressure_line_kernels.h"
+#undef LINE_REAL
+#undef LINE_NAME
+
+#define LINE_REAL float
+#define LINE_NAME(name) vof_pressure_line_##name##_f
+#include "vof_pressure_line_kernels.h"
+#undef LINE_REAL
+#undef LINE_NAME
+
+struct vof_pressure_relax {
+  int relaxation;      /* one of pressure_relaxations */
+  struct vof_pressure_line_coef_d d;
+  struct vof_pressure_line_coef_f f; /* float copy applied with pressure_pc_single */
+};
+
+struct vof_pressure_line {
+  struct solver_data *solver;
+  Mat A;               /* the full operator the coefficients come from */
+  long int planes, rows;
+  const char *active;  /* rows the krylov solver sees, NULL for all of them */
+  double *x, *y;       /* the vectors spread over every row, with active */
+  struct vof_pressure_relax relax[relax_count];
+};
+
+static struct vof_pressure_line line;
+
+static void vof_pressure_line_solve(struct vof_pressure_relax *r, const double *x, double *y) {
+  struct solver_data *solver = line.solver;
+
+  if(solver->pressure_pc_single) {
+    if(r->relaxation == relax_lines) vof_pressure_line_lines_f(solver, &r->f, line.planes, x, y);
+    else vof_pressure_line_points_f(solver, &r->f, line.planes, x, y);
+  }
+  else {
+    if(r->relaxation == relax_lines) vof_pressure_line_lines_d(solver, &r->d, line.planes, x, y);
+    else vof_pressure_line_points_d(solver, &r->d, line.planes, x, y);
+  }
+}
+
+static PetscErrorCode vof_pressure_line_apply(PC pc, Vec x, Vec y) {
+  struct vof_pressure_relax *r;
+  const PetscScalar *xv;
+  PetscScalar *yv;
+  PetscErrorCode ierr;
+  long int n, m;
+
+  ierr = PCShellGetContext(pc, &r);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(x, &xv);CHKERRQ(ierr);
+  ierr = VecGetArray(y, &yv);CHKERRQ(ierr);
+
+  if(line.active == NULL) {
+    vof_pressure_line_solve(r, xv, yv);
+  }
+  else {
+    for(n = 0, m = 0; n < line.rows; n++)
+      line.x[n] = line.active[n] ? xv[m++] : 0;
+    vof_pressure_line_solve(r, line.x, line.y);
+    for(n = 0, m = 0; n < line.rows; n++)
+      if(line.active[n]) yv[m++] = line.y[n];
+  }
+
+  ierr = VecRestoreArray(y, &yv);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(x, &xv);CHKERRQ(ierr);
+
+  return 0;
+}
+
+/* takes the coefficients of the operator and factors every column, or
+ * inverts the diagonal for the points */
+static PetscErrorCode vof_pressure_line_setup(PC pc) {
+  struct solver_data *solver = line.solver;
+  const long int jmax = solver->mesh->jmax, kmax = solver->mesh->kmax;
+  struct vof_pressure_relax *r;
+  struct vof_pressure_line_coef_d *a;
+  PetscErrorCode ierr;
+  long int c, k, n;
+  double piv;
+
+  ierr = PCShellGetContext(pc, &r);CHKERRQ(ierr);
+  a = &r->d;
+
+  if(solver->pressure_matrix_free) {
+    ierr = vof_pressure_shell_lines(line.A, a->lower, a->ip, a->cp, a->south, a->north);CHKERRQ(ierr);
+  }
+  else {
+    ierr = vof_pressure_csr_lines(a->lower, a->ip, a->cp, a->south, a->north);CHKERRQ(ierr);
+  }
+
+  /* rows left out of the solve are uncoupled */
+  if(line.active != NULL) {
+    for(n = 0; n < line.rows; n++) {
+      if(line.active[n]) continue;
+      a->ip[n] = 1;
+      a->lower[n] = a->cp[n] = a->south[n] = a->north[n] = 0;
+      if(n % kmax > 0) a->cp[n - 1] = 0;
+      if(n % kmax < kmax - 1) a->lower[n + 1] = 0;
+      if((n / kmax) % jmax > 0) a->north[n - kmax] = 0;
+      if((n / kmax) % jmax < jmax - 1) a->south[n + kmax] = 0;
+    }
+  }
+
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(c, k, n, piv) schedule(static)
+  for(c = 0; c < line.planes * jmax; c++) {
+    for(k = 0; k < kmax; k++) {
+      n = c * kmax + k;
+      piv = a->ip[n];
+      if(r->relaxation == relax_lines && k > 0) piv -= a->lower[n] * a->cp[n - 1];
+      a->ip[n] = (piv != 0) ? 1 / piv : 0;
+      if(r->relaxation == relax_lines) a->cp[n] *= a->ip[n];
+    }
+  }
+
+  if(solver->pressure_pc_single) {
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(n) schedule(static)
+    for(n = 0; n < line.rows; n++) {
+      r->f.lower[n] = a->lower[n];
+      r->f.ip[n] = a->ip[n];
+      r->f.cp[n] = a->cp[n];
+      r->f.south[n] = a->south[n];
+      r->f.north[n] = a->north[n];
+    }
+  }
+
+  return 0;
+}
+
+/* records the operator and the planes owned by this process */
+int vof_pressure_line_init(struct solver_data *solver, Mat A, long int planes) {
+  line.solver = solver;
+  line.A = A;
+  line.planes = planes;
+  line.rows = planes * JMAX * KMAX;
+  line.active = NULL;
+  line.x = NULL;
+  line.y = NULL;
+  memset(line.relax, 0, sizeof(line.relax));
+
+  return 0;
+}
+
+/* restricts the preconditioner to the active rows of a reduced system */
+int vof_pressure_line_set_active(const char *active) {
+  if(line.x == NULL) {
+    line.x = malloc(sizeof(double) * line.rows);
+    line.y = malloc(sizeof(double) * line.rows);
+    if(line.x == NULL || line.y == NULL) {
+      printf("error: could not allocate the line relaxation preconditioner\n");
+      return 1;
+    }
+  }
+  line.active = active;
+
+  return 0;
+}
+
+static int vof_pressure_line_alloc(struct vof_pressure_relax *r, int relaxation) {
+  struct solver_data *solver = line.solver;
+  const long int rows = line.rows;
+
+  if(r->d.ip != NULL) return 0;
+
+  r->relaxation = relaxation;
+  r->d.lower = malloc(sizeof(double) * rows);
+  r->d.ip    = malloc(sizeof(double) * rows);
+  r->d.cp    = malloc(sizeof(double) * rows);
+  r->d.south = malloc(sizeof(double) * rows);
+  r->d.north = malloc(sizeof(double) * rows);
+  if(r->d.lower == NULL || r->d.ip == NULL || r->d.cp == NULL || r->d.south == NULL || r->d.north == NULL) {
+    printf("error: could not allocate the line relaxation preconditioner\n");
+    return 1;
+  }
+
+  if(solver->pressure_pc_single) {
+    r->f.lower = malloc(sizeof(float) * rows);
+    r->f.ip    = malloc(sizeof(float) * rows);
+    r->f.cp    = malloc(sizeof(float) * rows);
+    r->f.south = malloc(sizeof(float) * rows);
+    r->f.north = malloc(sizeof(float) * rows);
+    if(r->f.lower == NULL || r->f.ip == NULL || r->f.cp == NULL || r->f.south == NULL || r->f.north == NULL) {
+      printf("error: could not allocate the line relaxation preconditioner\n");
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/* makes pc the relaxation, one of pressure_relaxations */
+int vof_pressure_line_pc(PC pc, int relaxation) {
+  PetscErrorCode ierr;
+
+  if(vof_pressure_line_alloc(&line.relax[relaxation], relaxation)) return 1;
+
+  ierr = PCSetType(pc, PCSHELL);CHKERRQ(ierr);
+  ierr = PCShellSetContext(pc, &line.relax[relaxation]);CHKERRQ(ierr);
+  ierr = PCShellSetSetUp(pc, vof_pressure_line_setup);CHKERRQ(ierr);
+  ierr = PCShellSetApply(pc, vof_pressure_line_apply);CHKERRQ(ierr);
+  ierr = PCShellSetName(pc, relaxation == relax_lines ? "vertical line relaxation" :
+                                                        "plane gauss-seidel");CHKERRQ(ierr);
+
+  return 0;
+}
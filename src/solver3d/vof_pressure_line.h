@@ -0,0 +1,19 @@
+/* vof_pressure_line.h
+ *
+ * plane-local relaxation preconditioners for the pressure solve
+ */
+
+#ifndef VOF_PRESSURE_LINE_H
+#define VOF_PRESSURE_LINE_H
+
+#include <petscksp.h>
+#include "solver_data.h"
+
+/* vertical lines solved exactly, or points relaxed by gauss-seidel */
+enum pressure_relaxations { relax_lines, relax_points, relax_count };
+
+int vof_pressure_line_init(struct solver_data *solver, Mat A, long int planes);
+int vof_pressure_line_set_active(const char *active);
+int vof_pressure_line_pc(PC pc, int relaxation);
+
+#endif
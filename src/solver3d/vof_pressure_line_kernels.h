@@ -0,0 +1,108 @@
+/* vof_pressure_line_kernels.h
+ *
+ * relaxation kernels of vof_pressure_line.c, included there once with
+ * double and once with float coefficients.  LINE_REAL is the type of the
+ * coefficients and LINE_NAME(name) names each copy.  the vectors stay
+ * double either way
+ */
+
+struct LINE_NAME(coef) {
+  LINE_REAL *lower;    /* coupling to k-1 */
+  LINE_REAL *ip;       /* inverse pivots of the factored columns, or inverse diagonal */
+  LINE_REAL *cp;       /* coupling to k+1, divided by the pivot for the lines */
+  LINE_REAL *south, *north;
+};
+
+/* solves column c in place, y holding the right hand side */
+static void LINE_NAME(column)(const struct LINE_NAME(coef) *a, long int kmax, long int c, double *y) {
+  const long int base = c * kmax;
+  long int k;
+
+  y[base] *= a->ip[base];
+  for(k = 1; k < kmax; k++)
+    y[base + k] = (y[base + k] - a->lower[base + k] * y[base + k - 1]) * a->ip[base + k];
+  for(k = kmax - 2; k >= 0; k--)
+    y[base + k] -= a->cp[base + k] * y[base + k + 1];
+}
+
+/* right hand side of column j of plane p, less its neighbours in y */
+static void LINE_NAME(rhs)(const struct LINE_NAME(coef) *a, long int jmax, long int kmax,
+                           long int p, long int j, const double *x, double *y) {
+  const long int base = (p * jmax + j) * kmax;
+  long int k, n;
+
+  for(k = 0; k < kmax; k++) {
+    n = base + k;
+    y[n] = x[n];
+    if(j > 0) y[n] -= a->south[n] * y[n - kmax];
+    if(j < jmax - 1) y[n] -= a->north[n] * y[n + kmax];
+  }
+}
+
+/* line jacobi, or symmetric line gauss-seidel along j within each plane */
+static void LINE_NAME(lines)(struct solver_data *solver, const struct LINE_NAME(coef) *a, long int planes,
+                             const double *x, double *y) {
+  const long int jmax = solver->mesh->jmax, kmax = solver->mesh->kmax;
+  long int c, p, j;
+
+  if(!solver->pressure_line_gs) {
+    memcpy(y, x, sizeof(double) * planes * jmax * kmax);
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(c) schedule(static)
+    for(c = 0; c < planes * jmax; c++)
+      LINE_NAME(column)(a, kmax, c, y);
+    return;
+  }
+
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(p, j) schedule(static)
+  for(p = 0; p < planes; p++) {
+    memset(y + p * jmax * kmax, 0, sizeof(double) * jmax * kmax);
+    for(j = 0; j < jmax; j++) {
+      LINE_NAME(rhs)(a, jmax, kmax, p, j, x, y);
+      LINE_NAME(column)(a, kmax, p * jmax + j, y);
+    }
+    for(j = jmax - 1; j >= 0; j--) {
+      LINE_NAME(rhs)(a, jmax, kmax, p, j, x, y);
+      LINE_NAME(column)(a, kmax, p * jmax + j, y);
+    }
+  }
+}
+
+/* one point gauss-seidel sweep forward and one back over each plane, as
+ * the SOR of the block jacobi does with omega 1 */
+static void LINE_NAME(points)(struct solver_data *solver, const struct LINE_NAME(coef) *a, long int planes,
+                              const double *x, double *y) {
+  const long int jmax = solver->mesh->jmax, kmax = solver->mesh->kmax;
+  long int p, n, first, last, k, j;
+  double s;
+
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(p, n, first, last, k, j, s) schedule(static)
+  for(p = 0; p < planes; p++) {
+    first = p * jmax * kmax;
+    last = first + jmax * kmax - 1;
+    memset(y + first, 0, sizeof(double) * jmax * kmax);
+
+    for(n = first; n <= last; n++) {
+      k = n % kmax;
+      j = (n / kmax) % jmax;
+      s = x[n];
+      if(k > 0) s -= a->lower[n] * y[n - 1];
+      if(k < kmax - 1) s -= a->cp[n] * y[n + 1];
+      if(j > 0) s -= a->south[n] * y[n - kmax];
+      if(j < jmax - 1) s -= a->north[n] * y[n + kmax];
+      y[n] = s * a->ip[n];
+    }
+    for(n = last; n >= first; n--) {
+      k = n % kmax;
+      j = (n / kmax) % jmax;
+      s = x[n];
+      if(k > 0) s -= a->lower[n] * y[n - 1];
+      if(k < kmax - 1) s -= a->cp[n] * y[n + 1];
+      if(j > 0) s -= a->south[n] * y[n - kmax];
+      if(j < jmax - 1) s -= a->north[n] * y[n + kmax];
+      y[n] = s * a->ip[n];
+    }
+  }
+}
@@ -21,6 +21,9 @@
 #include "track.h"
 #include "vof_boundary.h"
 #include "vof_mpi.h"
+#include "vof_pressure_shell.h"
+#include "vof_pressure_csr.h"
+#include "vof_pressure_line.h"
 
 #include "vof_macros.h"
 
@@ -34,73 +37,221 @@ int vof_pressure_gmres_boundary(struct solver_data *solver, Mat A, Vec b);
 int vof_pressure_gmres_write(Mat A, double timestep);
 int vof_pressure_gmres_boundary_edges(struct solver_data *solver, Mat A, Vec b);
 
+/* whether the vertical line relaxation is part of the preconditioner */
+static int vof_pressure_lines(struct solver_data *solver) {
+  return solver->pressure_pc == pressure_pc_line || solver->pressure_line_smoother || 
+         solver->pressure_pc_single;
+}
+
+/* whether the system is put in symmetric form for a cg method */
+static int vof_pressure_symmetric(struct solver_data *solver) {
+  return !solver->pressure_matrix_free &&
+         (solver->pressure_ksp == pressure_ksp_pipecg || solver->pressure_ksp == pressure_ksp_groppcg);
+}
+
+/* MatSetValue with INSERT_VALUES, written straight into the matrix layout
+ * or into the same row of the matrix-free operator */
+static int vof_pressure_set(struct solver_data *solver, Mat A, PetscInt row, PetscInt col, PetscScalar value) {
+  if(solver->pressure_matrix_free) return vof_pressure_shell_set(A, row, col, value);
+
+  return vof_pressure_csr_set(row, col, value);
+}
+
+/* writes a whole row of the 7-point stencil.  stencil marks an interior
+ * row, which the matrix-free operator rebuilds from the fractional areas */
+static int vof_pressure_set_row(struct solver_data *solver, Mat A, PetscInt row, PetscInt *cols,
+                                PetscScalar *values, int stencil) {
+  int n;
+
+  if(!solver->pressure_matrix_free) {
+    for(n = 0; n < 7; n++) 
+      if(vof_pressure_csr_set(row, cols[n], values[n])) return 1;
+    return 0;
+  }
+
+  if(stencil) return vof_pressure_shell_set_stencil(A, row);
+
+  vof_pressure_shell_clear(A, row);
+  for(n = 0; n < 7; n++) vof_pressure_shell_set(A, row, cols[n], values[n]);
+
+  return 0;
+}
+
+/* opens the matrix for the vof_pressure_set calls of a step */
+static int vof_pressure_begin(struct solver_data *solver, Mat A) {
+  if(solver->pressure_matrix_free) return 0;
+
+  return vof_pressure_csr_begin(A);
+}
+
+/* closes the matrix and marks it changed, so the preconditioner is rebuilt */
+static int vof_pressure_end(struct solver_data *solver, Mat A) {
+  if(solver->pressure_matrix_free) return PetscObjectStateIncrease((PetscObject) A);
+
+  return vof_pressure_csr_end(A);
+}
+
+/* sets up the preconditioner chosen by pressure_pc.  block jacobi takes
+ * one block per i-plane, each relaxed by SOR, of the rows in blks or of
+ * whole planes when blks is NULL.  gamg is algebraic multigrid with the
+ * constant near null space of the poisson operator.  lines solves each
+ * vertical column exactly, and pressure_line_smoother adds that before
+ * and after either of the others.  with pressure_pc_single the lines and
+ * the SOR of the block jacobi are our own sweeps over float coefficients */
+static int vof_pressure_gmres_pc(struct solver_data *solver, KSP ksp, Mat A, int range, const PetscInt *blks_in) {
+  PetscErrorCode ierr;
+  PC pc, subpc;
+  KSP *subksp;
+  MatNullSpace nullsp;
+  PetscInt i, *blks, nsub;
+  int nlocal, first;
+
+  ierr = KSPGetPC(ksp,&pc);CHKERRQ(ierr);
+
+  if(solver->pressure_pc == pressure_pc_line) {
+    ierr = vof_pressure_line_pc(pc, relax_lines);CHKERRQ(ierr);
+    ierr = KSPSetUp(ksp); CHKERRQ(ierr);
+
+    return 0;
+  }
+
+  if(solver->pressure_line_smoother) {
+    ierr = PCSetType(pc,PCCOMPOSITE);CHKERRQ(ierr);
+    ierr = PCCompositeSetType(pc,PC_COMPOSITE_SYMMETRIC_MULTIPLICATIVE);CHKERRQ(ierr);
+    /* set up again after a reset, the composite keeps its parts */
+    ierr = PCCompositeGetNumberPC(pc,&nsub);CHKERRQ(ierr);
+    if(nsub == 0) {
+      ierr = PCCompositeAddPCType(pc,PCSHELL);CHKERRQ(ierr);
+      ierr = PCCompositeAddPCType(pc,PCNONE);CHKERRQ(ierr);
+    }
+    ierr = PCCompositeGetPC(pc,0,&subpc);CHKERRQ(ierr);
+    ierr = vof_pressure_line_pc(subpc, relax_lines);CHKERRQ(ierr);
+    ierr = PCCompositeGetPC(pc,1,&pc);CHKERRQ(ierr);
+  }
+
+  if(solver->pressure_pc_single && solver->pressure_pc == pressure_pc_bjacobi) {
+    ierr = vof_pressure_line_pc(pc, relax_points);CHKERRQ(ierr);
+    ierr = KSPSetUp(ksp); CHKERRQ(ierr);
+
+    return 0;
+  }
+
+  /* without an assembled matrix only the diagonal is at hand */
+  if(solver->pressure_matrix_free) {
+    if(solver->pressure_pc != pressure_pc_bjacobi && !solver->rank)
+      printf("warning: the matrix-free pressure operator is preconditioned with jacobi\n");
+    ierr = PCSetType(pc,PCJACOBI);CHKERRQ(ierr);
+    ierr = KSPSetUp(ksp); CHKERRQ(ierr);
+
+    return 0;
+  }
+
+  if(solver->pressure_pc == pressure_pc_gamg) {
+    if(solver->pressure_pc_single && !solver->rank)
+      printf("warning: multigrid keeps its levels in double precision\n");
+    ierr = MatNullSpaceCreate(PETSC_COMM_WORLD,PETSC_TRUE,0,NULL,&nullsp);CHKERRQ(ierr);
+    ierr = MatSetNearNullSpace(A,nullsp);CHKERRQ(ierr);
+    ierr = MatNullSpaceDestroy(&nullsp);CHKERRQ(ierr);
+
+    ierr = PCSetType(pc,PCGAMG);CHKERRQ(ierr);
+    ierr = PCGAMGSetType(pc,PCGAMGAGG);CHKERRQ(ierr);
+    ierr = KSPSetUp(ksp); CHKERRQ(ierr);
+
+    return 0;
+  }
+
+  ierr = PCSetType(pc,PCBJACOBI);CHKERRQ(ierr);
+
+  //PCASMSetLocalSubdomains(pc, range, NULL, NULL);
+  //PCASMSetOverlap(pc, KMAX);
+  
+  ierr = PetscMalloc1(range,&blks);CHKERRQ(ierr);
+  for (i=0; i<range; i++) blks[i] = blks_in != NULL ? blks_in[i] : JMAX * KMAX;
+  ierr = PCBJacobiSetLocalBlocks(pc,range,blks);CHKERRQ(ierr);
+  ierr = PetscFree(blks);
+
+  ierr = KSPSetUp(ksp); CHKERRQ(ierr);
+  //ierr = KSPSetType(ksp,KSPGMRES); CHKERRQ(ierr);
+
+  //ierr = PCASMGetSubKSP(pc,&nlocal,&first,&subksp);CHKERRQ(ierr);
+  ierr = PCBJacobiGetSubKSP(pc,&nlocal,&first,&subksp);CHKERRQ(ierr);
+  for (i=0; i<nlocal; i++) {
+    ierr = KSPGetPC(subksp[i],&subpc);CHKERRQ(ierr);
+    ierr = PCSetType(subpc,PCSOR);CHKERRQ(ierr);
+    ierr = PCSORSetOmega(subpc, 1.0);
+    ierr = KSPSetType(subksp[i],KSPPREONLY);CHKERRQ(ierr);
+    ierr = KSPSetTolerances(subksp[i],solver->reltol,solver->abstol,PETSC_DEFAULT,solver->niter);CHKERRQ(ierr);
+  }
+
+  return 0;
+}
+
 int vof_pressure_gmres_boundary_edges(struct solver_data *solver, Mat A, Vec b) {
   PetscInt i,j,k,nidx;
 	PetscErrorCode ierr;
   int offset;
-  if(!solver->rank) offset = 0;
-  else offset=1;
+  offset = solver_mpi_wall(solver, 0) ? 0 : 1;
 
   for(j=0; j<JMAX-1; j++) {
 
-    if(ISTART == 0) {
-      nidx = mesh_index(solver->mesh,0,j,0);
-      ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+    if(solver_mpi_wall(solver, 0)) {
+      nidx = mesh_offset(solver->mesh,0,j,0);
+      ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
       ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
-      nidx = mesh_index(solver->mesh,0,j,KMAX-1);
-      ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+      nidx = mesh_offset(solver->mesh,0,j,KMAX-1);
+      ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
       ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
     }
 
-    if(ISTART + IRANGE == IMAX) {
-      nidx = mesh_index(solver->mesh,IMAX-1,j,0);
-      ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+    if(solver_mpi_wall(solver, 1)) {
+      nidx = mesh_offset(solver->mesh,IMAX-1,j,0);
+      ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
       ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
-      nidx = mesh_index(solver->mesh,IMAX-1,j,KMAX-1);
-      ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+      nidx = mesh_offset(solver->mesh,IMAX-1,j,KMAX-1);
+      ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
       ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
     }
   }
 
   for(i=offset; i<IRANGE; i++) {
-    nidx = mesh_index(solver->mesh,i+ISTART,0,0);
-    ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+    nidx = mesh_offset(solver->mesh,i+ISTART,0,0);
+    ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
     ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
-    nidx = mesh_index(solver->mesh,i+ISTART,JMAX-1,0);
-    ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+    nidx = mesh_offset(solver->mesh,i+ISTART,JMAX-1,0);
+    ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
     ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
-    nidx = mesh_index(solver->mesh,i+ISTART,0,KMAX-1);
-    ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+    nidx = mesh_offset(solver->mesh,i+ISTART,0,KMAX-1);
+    ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
     ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
-    nidx = mesh_index(solver->mesh,i+ISTART,JMAX-1,KMAX-1);
-    ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+    nidx = mesh_offset(solver->mesh,i+ISTART,JMAX-1,KMAX-1);
+    ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
     ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
   }
 
   for(k=0; k<KMAX-1; k++) {
 
-    if(ISTART == 0) {
-      nidx = mesh_index(solver->mesh,0,0,k);
-      ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+    if(solver_mpi_wall(solver, 0)) {
+      nidx = mesh_offset(solver->mesh,0,0,k);
+      ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
       ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
-      nidx = mesh_index(solver->mesh,0,JMAX-1,k);
-      ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+      nidx = mesh_offset(solver->mesh,0,JMAX-1,k);
+      ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
       ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
     }
 
-    if(ISTART + IRANGE == IMAX) {
-      nidx = mesh_index(solver->mesh,IMAX-1,0,k);
-      ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+    if(solver_mpi_wall(solver, 1)) {
+      nidx = mesh_offset(solver->mesh,IMAX-1,0,k);
+      ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
       ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
-      nidx = mesh_index(solver->mesh,IMAX-1,JMAX-1,k);
-      ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+      nidx = mesh_offset(solver->mesh,IMAX-1,JMAX-1,k);
+      ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
       ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
     }
   }
@@ -116,46 +267,45 @@ int vof_pressure_gmres_boundary(struct solver_data *solver, Mat A, Vec b) {
   int offset;
   double *vec;
 	
-  if(!solver->rank) offset = 0;
-  else offset=1;
+  offset = solver_mpi_wall(solver, 0) ? 0 : 1;
   ierr = VecGetArray(b,&vec); CHKERRQ(ierr);
 
 	for(j=1; j<JMAX-1; j++) {
     for(k=1; k<KMAX-1; k++) {
 
       /* west boundary */
-      if(ISTART == 0) {
+      if(solver_mpi_wall(solver, 0)) {
         wb = solver->mesh->wb[0];
         sb = vof_boundaries_check_inside_sb(solver, j, k, 0);
         if(sb == fixed_velocity || sb == mass_outflow || 
           (sb == wall && (wb == slip || wb == no_slip) ) ) {   
           
           if(FV(1,j,k) < solver->emf || AE(0,j,k) < solver->emf) {
-            nidx = mesh_index(solver->mesh,0,j,k);
-            ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+            nidx = mesh_offset(solver->mesh,0,j,k);
+            ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
             ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
             continue;
           }
           
-          nidx = mesh_index(solver->mesh,0,j,k);
-          nlmn = mesh_index(solver->mesh,1,j,k);
+          nidx = mesh_offset(solver->mesh,0,j,k);
+          nlmn = mesh_offset(solver->mesh,1,j,k);
           
           if(N_VOF(1,j,k) != 0) {
             /* explicit zero out since this could change */
-            ierr   = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
-            ierr   = MatSetValue(A,nidx,nlmn,0,INSERT_VALUES);CHKERRQ(ierr);
-            vec[mesh_index(solver->mesh,0,j,k)] = 0;
+            ierr   = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
+            ierr   = vof_pressure_set(solver,A,nidx,nlmn,0);CHKERRQ(ierr);
+            vec[mesh_offset(solver->mesh,0,j,k)] = 0;
             //ierr   = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
           } else {           
-            ierr   = MatSetValue(A,nidx,nidx,1/(solver->rho * solver->delt),INSERT_VALUES);CHKERRQ(ierr);
-            ierr   = MatSetValue(A,nidx,nlmn,-1.0/(solver->rho * solver->delt),INSERT_VALUES);CHKERRQ(ierr);
+            ierr   = vof_pressure_set(solver,A,nidx,nidx,1/(solver->rho * solver->delt));CHKERRQ(ierr);
+            ierr   = vof_pressure_set(solver,A,nidx,nlmn,-1.0/(solver->rho * solver->delt));CHKERRQ(ierr);
             //ierr   = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
-            vec[mesh_index(solver->mesh,0,j,k)] = 0;
+            vec[mesh_offset(solver->mesh,0,j,k)] = 0;
           }
         } else {
-            nidx = mesh_index(solver->mesh,0,j,k);
-            ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+            nidx = mesh_offset(solver->mesh,0,j,k);
+            ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
             ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
             continue;
@@ -167,36 +317,36 @@ int vof_pressure_gmres_boundary(struct solver_data *solver, Mat A, Vec b) {
     for(k=1; k<KMAX-1; k++) {
 
       /* east boundary */
-      if(ISTART + IRANGE == IMAX) {
+      if(solver_mpi_wall(solver, 1)) {
         wb = solver->mesh->wb[1];
         sb = vof_boundaries_check_inside_sb(solver, j, k, 1);
         if(sb == fixed_velocity || sb == mass_outflow || 
           (sb == wall && (wb == slip || wb == no_slip) ) ) {     
           
           if(FV(IRANGE-2,j,k) < solver->emf || AE(IRANGE-2,j,k) < solver->emf) {
-            nidx = mesh_index(solver->mesh,IMAX-1,j,k);
-            ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+            nidx = mesh_offset(solver->mesh,IMAX-1,j,k);
+            ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
             ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
             continue;
           } 
           
-          nidx = mesh_index(solver->mesh,IMAX-1,j,k);
-          nlmn = mesh_index(solver->mesh,IMAX-2,j,k);
+          nidx = mesh_offset(solver->mesh,IMAX-1,j,k);
+          nlmn = mesh_offset(solver->mesh,IMAX-2,j,k);
           
           if(N_VOF(IRANGE-2,j,k) != 0) {
             /* explicit zero out since this could change */
-            ierr   = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
-            ierr   = MatSetValue(A,nidx,nlmn,0,INSERT_VALUES);CHKERRQ(ierr);
+            ierr   = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
+            ierr   = vof_pressure_set(solver,A,nidx,nlmn,0);CHKERRQ(ierr);
             ierr   = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
           } else {        	
-            ierr   = MatSetValue(A,nidx,nidx,1/(solver->rho * solver->delt),INSERT_VALUES);CHKERRQ(ierr);
-            ierr   = MatSetValue(A,nidx,nlmn,-1.0/(solver->rho * solver->delt),INSERT_VALUES);CHKERRQ(ierr);
+            ierr   = vof_pressure_set(solver,A,nidx,nidx,1/(solver->rho * solver->delt));CHKERRQ(ierr);
+            ierr   = vof_pressure_set(solver,A,nidx,nlmn,-1.0/(solver->rho * solver->delt));CHKERRQ(ierr);
             ierr   = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
           }
         } else {
-            nidx = mesh_index(solver->mesh,IMAX-1,j,k);
-            ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+            nidx = mesh_offset(solver->mesh,IMAX-1,j,k);
+            ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
             ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
             continue;
@@ -217,31 +367,31 @@ int vof_pressure_gmres_boundary(struct solver_data *solver, Mat A, Vec b) {
       	 (sb == wall && (wb == slip || wb == no_slip) ) ) {    
       	 
       	if(FV(i,1,k) < solver->emf || AN(i,0,k) < solver->emf) {
-            nidx = mesh_index(solver->mesh,i+ISTART,0,k);
-            ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+            nidx = mesh_offset(solver->mesh,i+ISTART,0,k);
+            ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
             ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
             continue;
           }
         
-      	nidx = mesh_index(solver->mesh,i+ISTART,0,k);
-      	nlmn = mesh_index(solver->mesh,i+ISTART,1,k);
+      	nidx = mesh_offset(solver->mesh,i+ISTART,0,k);
+      	nlmn = mesh_offset(solver->mesh,i+ISTART,1,k);
         
         if(N_VOF(i,1,k) != 0) {
           /* explicit zero out since this could change */
-          ierr   = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
-          ierr   = MatSetValue(A,nidx,nlmn,0,INSERT_VALUES);CHKERRQ(ierr);
+          ierr   = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
+          ierr   = vof_pressure_set(solver,A,nidx,nlmn,0);CHKERRQ(ierr);
           //ierr   = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
-          vec[mesh_index(solver->mesh,i-offset,0,k)] = 0;
+          vec[mesh_offset(solver->mesh,i-offset,0,k)] = 0;
         } else {           
-          ierr   = MatSetValue(A,nidx,nidx,1/(solver->rho * solver->delt),INSERT_VALUES);CHKERRQ(ierr);
-          ierr   = MatSetValue(A,nidx,nlmn,-1.0/(solver->rho * solver->delt),INSERT_VALUES);CHKERRQ(ierr);
+          ierr   = vof_pressure_set(solver,A,nidx,nidx,1/(solver->rho * solver->delt));CHKERRQ(ierr);
+          ierr   = vof_pressure_set(solver,A,nidx,nlmn,-1.0/(solver->rho * solver->delt));CHKERRQ(ierr);
           //ierr   = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
-          vec[mesh_index(solver->mesh,i-offset,0,k)] = 0;
+          vec[mesh_offset(solver->mesh,i-offset,0,k)] = 0;
         }
       } else {
-            nidx = mesh_index(solver->mesh,i+ISTART,0,k);
-            ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+            nidx = mesh_offset(solver->mesh,i+ISTART,0,k);
+            ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
             ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
             continue;
@@ -258,32 +408,32 @@ int vof_pressure_gmres_boundary(struct solver_data *solver, Mat A, Vec b) {
       	 (sb == wall && (wb == slip || wb == no_slip) ) ) {   
       	 
       	if(FV(i,JMAX-2,k) < solver->emf || AN(i,JMAX-2,k) < solver->emf) {
-            nidx = mesh_index(solver->mesh,i+ISTART,JMAX-1,k);
-            ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+            nidx = mesh_offset(solver->mesh,i+ISTART,JMAX-1,k);
+            ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
             ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
             continue;
           }
         
-      	nidx = mesh_index(solver->mesh,i+ISTART,JMAX-1,k);
-      	nlmn = mesh_index(solver->mesh,i+ISTART,JMAX-2,k);
+      	nidx = mesh_offset(solver->mesh,i+ISTART,JMAX-1,k);
+      	nlmn = mesh_offset(solver->mesh,i+ISTART,JMAX-2,k);
         
         if(N_VOF(i,JMAX-2,k) != 0) {
           /* explicit zero out since this could change */
-          ierr   = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
-          ierr   = MatSetValue(A,nidx,nlmn,0,INSERT_VALUES);CHKERRQ(ierr);
+          ierr   = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
+          ierr   = vof_pressure_set(solver,A,nidx,nlmn,0);CHKERRQ(ierr);
           //ierr   = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
-          vec[mesh_index(solver->mesh,i-offset,JMAX-1,k)] = 0;
+          vec[mesh_offset(solver->mesh,i-offset,JMAX-1,k)] = 0;
         } else {        	
-          ierr   = MatSetValue(A,nidx,nidx,1/(solver->rho * solver->delt),INSERT_VALUES);CHKERRQ(ierr);
-          ierr   = MatSetValue(A,nidx,nlmn,-1.0/(solver->rho * solver->delt),INSERT_VALUES);CHKERRQ(ierr);
+          ierr   = vof_pressure_set(solver,A,nidx,nidx,1/(solver->rho * solver->delt));CHKERRQ(ierr);
+          ierr   = vof_pressure_set(solver,A,nidx,nlmn,-1.0/(solver->rho * solver->delt));CHKERRQ(ierr);
           //ierr   = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
-          vec[mesh_index(solver->mesh,i-offset,JMAX-1,k)] = 0;
+          vec[mesh_offset(solver->mesh,i-offset,JMAX-1,k)] = 0;
         }
    
       } else {
-            nidx = mesh_index(solver->mesh,i+ISTART,JMAX-1,k);
-            ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+            nidx = mesh_offset(solver->mesh,i+ISTART,JMAX-1,k);
+            ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
             ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
             continue;
@@ -303,32 +453,32 @@ int vof_pressure_gmres_boundary(struct solver_data *solver, Mat A, Vec b) {
       	 (sb == wall && (wb == slip || wb == no_slip) ) ) {  
       	 
       	if(FV(i,j,1) < solver->emf || AT(i,j,0) < solver->emf) {
-            nidx = mesh_index(solver->mesh,i+ISTART,j,0);
-            ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+            nidx = mesh_offset(solver->mesh,i+ISTART,j,0);
+            ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
             ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
             continue;
           }  
         
-      	nidx = mesh_index(solver->mesh,i+ISTART,j,0);
-      	nlmn = mesh_index(solver->mesh,i+ISTART,j,1);
+      	nidx = mesh_offset(solver->mesh,i+ISTART,j,0);
+      	nlmn = mesh_offset(solver->mesh,i+ISTART,j,1);
         
         if(N_VOF(i,j,1) != 0) {
           /* explicit zero out since this could change */
-          ierr   = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
-          ierr   = MatSetValue(A,nidx,nlmn,0,INSERT_VALUES);CHKERRQ(ierr);
+          ierr   = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
+          ierr   = vof_pressure_set(solver,A,nidx,nlmn,0);CHKERRQ(ierr);
           //ierr   = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
-          vec[mesh_index(solver->mesh,i-offset,j,0)] = 0;
+          vec[mesh_offset(solver->mesh,i-offset,j,0)] = 0;
         } else {           
-          ierr   = MatSetValue(A,nidx,nidx,1/(solver->rho * solver->delt),INSERT_VALUES);CHKERRQ(ierr);
-          ierr   = MatSetValue(A,nidx,nlmn,-1.0/(solver->rho * solver->delt),INSERT_VALUES);CHKERRQ(ierr);
+          ierr   = vof_pressure_set(solver,A,nidx,nidx,1/(solver->rho * solver->delt));CHKERRQ(ierr);
+          ierr   = vof_pressure_set(solver,A,nidx,nlmn,-1.0/(solver->rho * solver->delt));CHKERRQ(ierr);
           //ierr   = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
-          vec[mesh_index(solver->mesh,i-offset,j,0)] = 0;
+          vec[mesh_offset(solver->mesh,i-offset,j,0)] = 0;
         }
             
       } else {
-            nidx = mesh_index(solver->mesh,i+ISTART,j,0);
-            ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+            nidx = mesh_offset(solver->mesh,i+ISTART,j,0);
+            ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
             ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
             continue;
@@ -346,31 +496,31 @@ int vof_pressure_gmres_boundary(struct solver_data *solver, Mat A, Vec b) {
       	 (sb == wall && (wb == slip || wb == no_slip) ) ) {    
       	 
       	if(FV(i,j,KMAX-2) < solver->emf || AT(i,j,KMAX-2) < solver->emf) {
-            nidx = mesh_index(solver->mesh,i+ISTART,j,KMAX-1);
-            ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+            nidx = mesh_offset(solver->mesh,i+ISTART,j,KMAX-1);
+            ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
             ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
             continue;
           }    
         
-      	nidx = mesh_index(solver->mesh,i+ISTART,j,KMAX-1);
-      	nlmn = mesh_index(solver->mesh,i+ISTART,j,KMAX-2);
+      	nidx = mesh_offset(solver->mesh,i+ISTART,j,KMAX-1);
+      	nlmn = mesh_offset(solver->mesh,i+ISTART,j,KMAX-2);
         
         if(N_VOF(i,j,KMAX-2) != 0) {
           /* explicit zero out since this could change */
-          ierr   = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
-          ierr   = MatSetValue(A,nidx,nlmn,0,INSERT_VALUES);CHKERRQ(ierr);
+          ierr   = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
+          ierr   = vof_pressure_set(solver,A,nidx,nlmn,0);CHKERRQ(ierr);
           //ierr   = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
-          vec[mesh_index(solver->mesh,i-offset,j,KMAX-1)] = 0;
+          vec[mesh_offset(solver->mesh,i-offset,j,KMAX-1)] = 0;
         } else {        	
-          ierr   = MatSetValue(A,nidx,nidx,1/(solver->rho * solver->delt),INSERT_VALUES);CHKERRQ(ierr);
-          ierr   = MatSetValue(A,nidx,nlmn,-1.0/(solver->rho * solver->delt),INSERT_VALUES);CHKERRQ(ierr);
+          ierr   = vof_pressure_set(solver,A,nidx,nidx,1/(solver->rho * solver->delt));CHKERRQ(ierr);
+          ierr   = vof_pressure_set(solver,A,nidx,nlmn,-1.0/(solver->rho * solver->delt));CHKERRQ(ierr);
           //ierr   = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
-          vec[mesh_index(solver->mesh,i-offset,j,KMAX-1)] = 0;
+          vec[mesh_offset(solver->mesh,i-offset,j,KMAX-1)] = 0;
         }
       } else {
-            nidx = mesh_index(solver->mesh,i+ISTART,j,KMAX-1);
-            ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+            nidx = mesh_offset(solver->mesh,i+ISTART,j,KMAX-1);
+            ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
             ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
             continue;
@@ -408,20 +558,20 @@ int vof_pressure_gmres_assemble(struct solver_data *solver, Mat A, Vec b) {
       
         
         if(FV(i,j,k)<emf) {
-          nidx = mesh_index(solver->mesh,i+ISTART,j,k);
-          ierr = MatSetValue(A,nidx,nidx,1,INSERT_VALUES);CHKERRQ(ierr);
+          nidx = mesh_offset(solver->mesh,i+ISTART,j,k);
+          ierr = vof_pressure_set(solver,A,nidx,nidx,1);CHKERRQ(ierr);
           ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
 
           continue;
         }
                        
-        row_idx[0] = mesh_index(solver->mesh,i+ISTART,j,k);   
-        row_idx[1] = mesh_index(solver->mesh,i+1+ISTART,j,k);  
-        row_idx[2] = mesh_index(solver->mesh,i-1+ISTART,j,k);  
-        row_idx[3] = mesh_index(solver->mesh,i+ISTART,j+1,k);
-        row_idx[4] = mesh_index(solver->mesh,i+ISTART,j-1,k);
-        row_idx[5] = mesh_index(solver->mesh,i+ISTART,j,k+1);
-        row_idx[6] = mesh_index(solver->mesh,i+ISTART,j,k-1);
+        row_idx[0] = mesh_offset(solver->mesh,i+ISTART,j,k);   
+        row_idx[1] = mesh_offset(solver->mesh,i+1+ISTART,j,k);  
+        row_idx[2] = mesh_offset(solver->mesh,i-1+ISTART,j,k);  
+        row_idx[3] = mesh_offset(solver->mesh,i+ISTART,j+1,k);
+        row_idx[4] = mesh_offset(solver->mesh,i+ISTART,j-1,k);
+        row_idx[5] = mesh_offset(solver->mesh,i+ISTART,j,k+1);
+        row_idx[6] = mesh_offset(solver->mesh,i+ISTART,j,k-1);
                
         if(N_VOF(i,j,k) != 0) {
         
@@ -458,19 +608,19 @@ int vof_pressure_gmres_assemble(struct solver_data *solver, Mat A, Vec b) {
           case none:
           default: 
             row[0] = 1;
-            nidx = mesh_index(solver->mesh,i+ISTART,j,k);
-            ierr = MatSetValues(A,1,&nidx,7,row_idx,row,INSERT_VALUES);CHKERRQ(ierr);
+            nidx = mesh_offset(solver->mesh,i+ISTART,j,k);
+            ierr = vof_pressure_set_row(solver,A,nidx,row_idx,row,0);CHKERRQ(ierr);
             ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
             continue;
           }
           
-          nidx = mesh_index(solver->mesh,i+ISTART,j,k);
+          nidx = mesh_offset(solver->mesh,i+ISTART,j,k);
           
           if(N_VOF(l,m,n) != 0) {
             row[0] = 1 / (solver->rho * solver->delt);
             dpijk = 0 - P(i,j,k);
             dpijk /= (solver->rho * solver->delt);
-            ierr = MatSetValues(A,1,&nidx,7,row_idx,row,INSERT_VALUES);CHKERRQ(ierr);
+            ierr = vof_pressure_set_row(solver,A,nidx,row_idx,row,0);CHKERRQ(ierr);
             ierr = VecSetValue(b,nidx,dpijk,INSERT_VALUES);CHKERRQ(ierr);
           	continue;
           }
@@ -483,7 +633,7 @@ int vof_pressure_gmres_assemble(struct solver_data *solver, Mat A, Vec b) {
           row[0] = 1 / (solver->rho * solver->delt);
           row[ridx] = -1.0 * mpeta / (solver->rho * solver->delt);
           
-    			ierr = MatSetValues(A,1,&nidx,7,row_idx,row,INSERT_VALUES);CHKERRQ(ierr);
+    			ierr = vof_pressure_set_row(solver,A,nidx,row_idx,row,0);CHKERRQ(ierr);
           ierr = VecSetValue(b,nidx,dpijk,INSERT_VALUES);CHKERRQ(ierr);
           
           
@@ -506,8 +656,8 @@ int vof_pressure_gmres_assemble(struct solver_data *solver, Mat A, Vec b) {
         	row[5] = r_rhodz2 * AT(i,j,k);
         	row[6] = r_rhodz2 * AT(i,j,k-1);
         	
-        	nidx = mesh_index(solver->mesh,i+ISTART,j,k);
-    			ierr   = MatSetValues(A,1,&nidx,7,row_idx,row,INSERT_VALUES);CHKERRQ(ierr);
+        	nidx = mesh_offset(solver->mesh,i+ISTART,j,k);
+    			ierr   = vof_pressure_set_row(solver,A,nidx,row_idx,row,1);CHKERRQ(ierr);
     			
     			rhs  = (AE(i,j,k) * U(i,j,k) - AE(i-1,j,k) * U(i-1,j,k)) * RDX;
     			rhs += (AN(i,j,k) * V(i,j,k) - AN(i,j-1,k) * V(i,j-1,k)) * RDY;
@@ -549,8 +699,7 @@ int vof_pressure_gmres_update(struct solver_data *solver, Mat A, Vec b) {
   int offset;
   double *vec;
 	
-  if(!solver->rank) offset = 0;
-  else offset=1;
+  offset = solver_mpi_wall(solver, 0) ? 0 : 1;
   ierr = VecGetArray(b,&vec); CHKERRQ(ierr);
 	
 	r_rhodx2 = 1/solver->rho * 1/pow(DELX,2);
@@ -566,13 +715,13 @@ int vof_pressure_gmres_update(struct solver_data *solver, Mat A, Vec b) {
         
         if(FV(i,j,k)<emf) continue;
                        
-        row_idx[0] = mesh_index(solver->mesh,i+ISTART,j,k);   
-        row_idx[1] = mesh_index(solver->mesh,i+1+ISTART,j,k);  
-        row_idx[2] = mesh_index(solver->mesh,i-1+ISTART,j,k);  
-        row_idx[3] = mesh_index(solver->mesh,i+ISTART,j+1,k);
-        row_idx[4] = mesh_index(solver->mesh,i+ISTART,j-1,k);
-        row_idx[5] = mesh_index(solver->mesh,i+ISTART,j,k+1);
-        row_idx[6] = mesh_index(solver->mesh,i+ISTART,j,k-1);
+        row_idx[0] = mesh_offset(solver->mesh,i+ISTART,j,k);   
+        row_idx[1] = mesh_offset(solver->mesh,i+1+ISTART,j,k);  
+        row_idx[2] = mesh_offset(solver->mesh,i-1+ISTART,j,k);  
+        row_idx[3] = mesh_offset(solver->mesh,i+ISTART,j+1,k);
+        row_idx[4] = mesh_offset(solver->mesh,i+ISTART,j-1,k);
+        row_idx[5] = mesh_offset(solver->mesh,i+ISTART,j,k+1);
+        row_idx[6] = mesh_offset(solver->mesh,i+ISTART,j,k-1);
                
         if(N_VOF(i,j,k) != 0) {
         
@@ -610,22 +759,22 @@ int vof_pressure_gmres_update(struct solver_data *solver, Mat A, Vec b) {
           default: 
             row[0] = 1;
             if(N_VOF_N(i,j,k) == N_VOF(i,j,k)) continue;
-            nidx = mesh_index(solver->mesh,i+ISTART,j,k);
-            ierr = MatSetValues(A,1,&nidx,7,row_idx,row,INSERT_VALUES);CHKERRQ(ierr);
+            nidx = mesh_offset(solver->mesh,i+ISTART,j,k);
+            ierr = vof_pressure_set_row(solver,A,nidx,row_idx,row,0);CHKERRQ(ierr);
             //ierr = VecSetValue(b,nidx,0,INSERT_VALUES);CHKERRQ(ierr);
-            vec[mesh_index(solver->mesh,i-offset,j,k)] = 0;
+            vec[mesh_offset(solver->mesh,i-offset,j,k)] = 0;
             continue;
           }
           
-          nidx = mesh_index(solver->mesh,i+ISTART,j,k);
+          nidx = mesh_offset(solver->mesh,i+ISTART,j,k);
           
           if(N_VOF(l,m,n) != 0) {
             row[0] = 1 / (solver->rho * solver->delt);
             dpijk = 0 - P(i,j,k);
             dpijk /= (solver->rho * solver->delt);
-            ierr = MatSetValues(A,1,&nidx,7,row_idx,row,INSERT_VALUES);CHKERRQ(ierr);
+            ierr = vof_pressure_set_row(solver,A,nidx,row_idx,row,0);CHKERRQ(ierr);
             //ierr = VecSetValue(b,nidx,dpijk,INSERT_VALUES);CHKERRQ(ierr);
-            vec[mesh_index(solver->mesh,i-offset,j,k)] = dpijk;
+            vec[mesh_offset(solver->mesh,i-offset,j,k)] = dpijk;
           	continue;
           }
           
@@ -637,13 +786,13 @@ int vof_pressure_gmres_update(struct solver_data *solver, Mat A, Vec b) {
           row[0] = 1 / (solver->rho * solver->delt);
           row[ridx] = -1.0 * mpeta / (solver->rho * solver->delt);
           
-    			ierr = MatSetValues(A,1,&nidx,7,row_idx,row,INSERT_VALUES);CHKERRQ(ierr);
+    			ierr = vof_pressure_set_row(solver,A,nidx,row_idx,row,0);CHKERRQ(ierr);
           //ierr = VecSetValue(b,nidx,dpijk,INSERT_VALUES);CHKERRQ(ierr);
-          vec[mesh_index(solver->mesh,i-offset,j,k)] = dpijk;
+          vec[mesh_offset(solver->mesh,i-offset,j,k)] = dpijk;
           
           
         }
-        else if(N_VOF_N(i,j,k) != 0) {
+        else if(N_VOF_N(i,j,k) != 0 || vof_pressure_symmetric(solver)) {
         /* interior non-void cell */
         
         	dpijk = r_rhodx2 * (AE(i,j,k) + AE(i-1,j,k)) + 
@@ -662,8 +811,8 @@ int vof_pressure_gmres_update(struct solver_data *solver, Mat A, Vec b) {
         	row[5] = r_rhodz2 * AT(i,j,k);
         	row[6] = r_rhodz2 * AT(i,j,k-1);
         	
-        	nidx = mesh_index(solver->mesh,i+ISTART,j,k);
-    			ierr   = MatSetValues(A,1,&nidx,7,row_idx,row,INSERT_VALUES);CHKERRQ(ierr);
+        	nidx = mesh_offset(solver->mesh,i+ISTART,j,k);
+    			ierr   = vof_pressure_set_row(solver,A,nidx,row_idx,row,1);CHKERRQ(ierr);
     			
     			rhs  = (AE(i,j,k) * U(i,j,k) - AE(i-1,j,k) * U(i-1,j,k)) * RDX;
     			rhs += (AN(i,j,k) * V(i,j,k) - AN(i,j-1,k) * V(i,j-1,k)) * RDY;
@@ -683,11 +832,11 @@ int vof_pressure_gmres_update(struct solver_data *solver, Mat A, Vec b) {
           rhs /= solver->delt;
           
     			//ierr   = VecSetValue(b,nidx,rhs,INSERT_VALUES);CHKERRQ(ierr);
-          vec[mesh_index(solver->mesh,i-offset,j,k)] = rhs;
+          vec[mesh_offset(solver->mesh,i-offset,j,k)] = rhs;
         }
         else {
     			
-        	nidx = mesh_index(solver->mesh,i+ISTART,j,k);
+        	nidx = mesh_offset(solver->mesh,i+ISTART,j,k);
     			rhs  = (AE(i,j,k) * U(i,j,k) - AE(i-1,j,k) * U(i-1,j,k)) * RDX;
     			rhs += (AN(i,j,k) * V(i,j,k) - AN(i,j-1,k) * V(i,j-1,k)) * RDY;
     			rhs += (AT(i,j,k) * W(i,j,k) - AT(i,j,k-1) * W(i,j,k-1)) * RDZ;     
@@ -706,7 +855,7 @@ int vof_pressure_gmres_update(struct solver_data *solver, Mat A, Vec b) {
           rhs /= solver->delt;
           
     			//ierr   = VecSetValue(b,nidx,rhs,INSERT_VALUES);CHKERRQ(ierr);
-          vec[mesh_index(solver->mesh,i-offset,j,k)] = rhs;
+          vec[mesh_offset(solver->mesh,i-offset,j,k)] = rhs;
         }
         
         
@@ -718,6 +867,365 @@ int vof_pressure_gmres_update(struct solver_data *solver, Mat A, Vec b) {
   return 0;
 }
 
+/* whether this step may keep the preconditioner built on an earlier one.
+ * it is rebuilt after pressure_pc_reuse steps, once the last solve took
+ * more than pressure_pc_reuse_iter iterations, or once the share of cells
+ * whose N_VOF changed since it was built passes pressure_pc_reuse_changed.
+ * the counts are summed over every rank so all of them agree */
+static int vof_pressure_gmres_reuse(struct solver_data *solver, long int last_iter) {
+  static long int steps = 0; /* steps since the preconditioner was built */
+  static double changed = 0; /* cells whose N_VOF changed since then */
+  const struct mesh_view view = mesh_view(solver->mesh, solver->mesh->u);
+  const enum cell_boundaries * const n_vof = solver->mesh->n_vof;
+  const enum cell_boundaries * const n_vof_n = mesh_n->n_vof;
+  const long int irange = IRANGE, jmax = JMAX, kmax = KMAX;
+  long int i, j, k, l, count = 0;
+  double cells;
+
+  if(solver->pressure_pc_reuse < 1) return 0;
+
+  if(solver->pressure_pc_reuse_changed > 0) {
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(i, j, k, l) reduction(+:count) schedule(static)
+    for(i=1; i<irange-1; i++) {
+      for(j=1; j<jmax-1; j++) {
+        for(k=1; k<kmax-1; k++) {
+          l = MESH_VIEW_OFFSET(view, i, j, k);
+          if(n_vof[l] != n_vof_n[l]) count++;
+        }
+      }
+    }
+    changed += solver_mpi_sum(solver, count);
+  }
+  cells = (double) (IMAX - 2) * (JMAX - 2) * (KMAX - 2);
+
+  if(steps >= solver->pressure_pc_reuse ||
+     (solver->pressure_pc_reuse_iter > 0 && last_iter > solver->pressure_pc_reuse_iter) ||
+     (solver->pressure_pc_reuse_changed > 0 && changed > solver->pressure_pc_reuse_changed * cells)) {
+    steps = 0;
+    changed = 0;
+    return 0;
+  }
+
+  steps++;
+  return 1;
+}
+
+/* sets the krylov method chosen by pressure_ksp */
+static int vof_pressure_gmres_ksp(struct solver_data *solver, KSP ksp) {
+  const KSPType types[pressure_ksp_count] = { KSPGMRES, KSPPGMRES, KSPPIPECG, KSPGROPPCG };
+  PetscErrorCode ierr;
+
+  if(solver->pressure_matrix_free && 
+     (solver->pressure_ksp == pressure_ksp_pipecg || solver->pressure_ksp == pressure_ksp_groppcg)) {
+    if(!solver->rank)
+      printf("warning: the matrix-free pressure operator is not symmetric, using pipelined gmres\n");
+    solver->pressure_ksp = pressure_ksp_pgmres;
+  }
+
+  ierr = KSPSetType(ksp, types[solver->pressure_ksp]);CHKERRQ(ierr);
+
+  return 0;
+}
+
+/* an interior cell next to a boundary cell whose row copies the interior
+ * value takes that copy into its own diagonal, dropping the coupling */
+static int vof_pressure_gmres_fold_cell(struct solver_data *solver, long int i, long int j, long int k,
+                                        PetscInt ghost) {
+  PetscInt row;
+  PetscScalar diag, off;
+
+  if(FV(i,j,k) < emf || N_VOF(i,j,k) != 0) return 0;
+
+  row = mesh_offset(solver->mesh,i+ISTART,j,k);
+  if(vof_pressure_csr_get(ghost, row) == 0) return 0;
+
+  diag = vof_pressure_csr_get(row, row);
+  off = vof_pressure_csr_get(row, ghost);
+  if(vof_pressure_csr_set(row, row, diag + off)) return 1;
+  if(vof_pressure_csr_set(row, ghost, 0)) return 1;
+
+  return 0;
+}
+
+/* first half of the symmetric form, done while the values are open: the
+ * zero gradient boundary rows are folded into the interior */
+static int vof_pressure_gmres_fold(struct solver_data *solver) {
+  long int i, j, k;
+
+  for(j=1; j<JMAX-1; j++) {
+    for(k=1; k<KMAX-1; k++) {
+      if(solver_mpi_wall(solver, 0) && IRANGE > 2)
+        if(vof_pressure_gmres_fold_cell(solver, 1, j, k, mesh_offset(solver->mesh,0,j,k))) return 1;
+      if(solver_mpi_wall(solver, 1) && IRANGE > 2)
+        if(vof_pressure_gmres_fold_cell(solver, IRANGE-2, j, k, mesh_offset(solver->mesh,IMAX-1,j,k))) return 1;
+    }
+  }
+
+  for(i=1; i<IRANGE-1; i++) {
+    for(k=1; k<KMAX-1; k++) {
+      if(vof_pressure_gmres_fold_cell(solver, i, 1, k, mesh_offset(solver->mesh,i+ISTART,0,k))) return 1;
+      if(vof_pressure_gmres_fold_cell(solver, i, JMAX-2, k, mesh_offset(solver->mesh,i+ISTART,JMAX-1,k))) return 1;
+    }
+    for(j=1; j<JMAX-1; j++) {
+      if(vof_pressure_gmres_fold_cell(solver, i, j, 1, mesh_offset(solver->mesh,i+ISTART,j,0))) return 1;
+      if(vof_pressure_gmres_fold_cell(solver, i, j, KMAX-2, mesh_offset(solver->mesh,i+ISTART,j,KMAX-1))) return 1;
+    }
+  }
+
+  return 0;
+}
+
+/* second half of the symmetric form.  every row that is not an interior
+ * fluid cell is fixed at its value with the coupling to its neighbour
+ * dropped, which lags the free surface interpolation by one solve, and
+ * its column is moved into the right hand side.  the fixed rows get -1 on
+ * the diagonal so the whole operator stays negative definite */
+static int vof_pressure_gmres_eliminate(struct solver_data *solver, Mat A, Vec b) {
+  static Vec fixed = NULL, diag;
+  const PetscScalar *bv, *dv;
+  PetscScalar *xv;
+  PetscErrorCode ierr;
+  PetscInt *rows, row_start, row_end, count;
+  long int n, i, j, k, plane, first;
+
+  if(fixed == NULL) {
+    ierr = VecDuplicate(b, &fixed);CHKERRQ(ierr);
+    ierr = VecDuplicate(b, &diag);CHKERRQ(ierr);
+  }
+
+  ierr = MatGetOwnershipRange(A, &row_start, &row_end);CHKERRQ(ierr);
+  ierr = MatGetDiagonal(A, diag);CHKERRQ(ierr);
+  ierr = PetscMalloc1(row_end - row_start, &rows);CHKERRQ(ierr);
+
+  plane = JMAX * KMAX;
+  first = solver_mpi_wall(solver, 0) ? 0 : 1;
+  count = 0;
+
+  ierr = VecGetArrayRead(b, &bv);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(diag, &dv);CHKERRQ(ierr);
+  ierr = VecGetArray(fixed, &xv);CHKERRQ(ierr);
+  for(n = 0; n < row_end - row_start; n++) {
+    i = n / plane + first;
+    j = (n / KMAX) % JMAX;
+    k = n % KMAX;
+
+    xv[n] = 0;
+    if(i > 0 && i < IRANGE-1 && j > 0 && j < JMAX-1 && k > 0 && k < KMAX-1 &&
+       FV(i,j,k) >= emf && N_VOF(i,j,k) == 0) continue;
+
+    rows[count++] = row_start + n;
+    xv[n] = bv[n] / dv[n];
+  }
+  ierr = VecRestoreArray(fixed, &xv);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(diag, &dv);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(b, &bv);CHKERRQ(ierr);
+
+  ierr = MatZeroRowsColumns(A, count, rows, -1.0, fixed, b);CHKERRQ(ierr);
+  ierr = PetscFree(rows);CHKERRQ(ierr);
+
+  return 0;
+}
+
+/* seconds this process has spent so far in the vector operations that
+ * end in a global reduction, as logged by petsc */
+static double vof_pressure_gmres_reductions(void) {
+  const char *events[4] = { "VecNorm", "VecDot", "VecMDot", "VecReduceEnd" };
+  PetscEventPerfInfo info;
+  PetscLogEvent event;
+  double t = 0;
+  int n;
+
+  for(n = 0; n < 4; n++) {
+    if(PetscLogEventGetId(events[n], &event)) continue;
+    if(PetscLogEventGetPerfInfo(PETSC_DETERMINE, event, &info)) continue;
+    t += info.time;
+  }
+
+  return t;
+}
+
+/* with pressure_active_only the krylov solver only sees the active rows.
+ * the rest are the identity rows of solid, empty and boundary cells with
+ * a zero right hand side, whose correction is zero, so leaving them and
+ * their columns out does not change the solution */
+static IS active_is = NULL;
+static Mat active_A = NULL;
+static char *active_rows = NULL;   /* per owned row */
+static char *active_identity = NULL;
+static PetscInt *active_blks = NULL; /* active rows of each plane holding any */
+static int active_nblocks = 0;
+
+static int vof_pressure_active(struct solver_data *solver) {
+  return solver->pressure_active_only && !solver->pressure_matrix_free;
+}
+
+/* works out the active rows from the assembled system and takes the
+ * submatrix over them.  when the pattern changed on any rank the index
+ * set, the submatrix and the preconditioner are built again */
+static int vof_pressure_gmres_active(struct solver_data *solver, KSP ksp, Mat A, Vec b, int range) {
+  const PetscScalar *bv;
+  PetscErrorCode ierr;
+  PetscInt row_start, row_end, *idx;
+  long int n, p, rows, plane, count, changed = 0;
+  char active;
+
+  rows = (long int) range * JMAX * KMAX;
+  plane = JMAX * KMAX;
+
+  if(active_rows == NULL) {
+    active_rows = calloc(rows, sizeof(char));
+    active_identity = malloc(sizeof(char) * rows);
+    active_blks = malloc(sizeof(PetscInt) * range);
+    if(active_rows == NULL || active_identity == NULL || active_blks == NULL) {
+      printf("error: could not allocate the active pressure rows\n");
+      return 1;
+    }
+    if(vof_pressure_lines(solver) && vof_pressure_line_set_active(active_rows)) return 1;
+  }
+
+  ierr = vof_pressure_csr_identity(active_identity);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(b, &bv);CHKERRQ(ierr);
+  for(n = 0; n < rows; n++) {
+    active = !(active_identity[n] && bv[n] == 0);
+    if(active != active_rows[n]) {
+      active_rows[n] = active;
+      changed++;
+    }
+  }
+  ierr = VecRestoreArrayRead(b, &bv);CHKERRQ(ierr);
+
+  if(active_A != NULL && solver_mpi_sum(solver, changed) == 0) {
+    ierr = MatCreateSubMatrix(A, active_is, active_is, MAT_REUSE_MATRIX, &active_A);CHKERRQ(ierr);
+    return 0;
+  }
+
+  ierr = MatGetOwnershipRange(A, &row_start, &row_end);CHKERRQ(ierr);
+  ierr = PetscMalloc1(rows, &idx);CHKERRQ(ierr);
+  count = 0;
+  active_nblocks = 0;
+  for(p = 0; p < range; p++) {
+    active_blks[active_nblocks] = 0;
+    for(n = p * plane; n < (p + 1) * plane; n++) {
+      if(!active_rows[n]) continue;
+      idx[count++] = row_start + n;
+      active_blks[active_nblocks]++;
+    }
+    if(active_blks[active_nblocks] > 0) active_nblocks++;
+  }
+
+  ierr = ISDestroy(&active_is);CHKERRQ(ierr);
+  ierr = ISCreateGeneral(PETSC_COMM_WORLD, count, idx, PETSC_OWN_POINTER, &active_is);CHKERRQ(ierr);
+  ierr = MatDestroy(&active_A);CHKERRQ(ierr);
+  ierr = MatCreateSubMatrix(A, active_is, active_is, MAT_INITIAL_MATRIX, &active_A);CHKERRQ(ierr);
+
+  /* the size of the system changed, start the solver over */
+  ierr = KSPReset(ksp);CHKERRQ(ierr);
+  ierr = KSPSetOperators(ksp, active_A, active_A);CHKERRQ(ierr);
+  ierr = vof_pressure_gmres_pc(solver, ksp, active_A, active_nblocks, active_blks);CHKERRQ(ierr);
+
+  /* summed and reported with the timers at each write */
+  solver->pressure_active_rows = count;
+
+  return 0;
+}
+
+/* sets up the preconditioner again after pressure_pc changed */
+static int vof_pressure_gmres_pc_reset(struct solver_data *solver, KSP ksp, Mat A, int range) {
+  if(vof_pressure_active(solver)) 
+    return vof_pressure_gmres_pc(solver, ksp, active_A, active_nblocks, active_blks);
+
+  return vof_pressure_gmres_pc(solver, ksp, A, range, NULL);
+}
+
+/* solves for x, over the active rows alone when the system is reduced.
+ * x then gets a zero correction in every other row */
+static int vof_pressure_gmres_solve(struct solver_data *solver, KSP ksp, Vec b, Vec x) {
+  PetscErrorCode ierr;
+  PetscScalar *xv;
+  PetscInt n, rows;
+  Vec bs, xs;
+
+  if(!vof_pressure_active(solver)) {
+    ierr = KSPSolve(ksp,b,x);CHKERRQ(ierr);
+    return 0;
+  }
+
+  ierr = VecGetSubVector(b, active_is, &bs);CHKERRQ(ierr);
+  ierr = VecGetSubVector(x, active_is, &xs);CHKERRQ(ierr);
+  ierr = KSPSolve(ksp,bs,xs);CHKERRQ(ierr);
+  ierr = VecRestoreSubVector(b, active_is, &bs);CHKERRQ(ierr);
+  ierr = VecRestoreSubVector(x, active_is, &xs);CHKERRQ(ierr);
+
+  ierr = VecGetLocalSize(x, &rows);CHKERRQ(ierr);
+  ierr = VecGetArray(x, &xv);CHKERRQ(ierr);
+  for(n = 0; n < rows; n++)
+    if(!active_rows[n]) xv[n] = 0;
+  ierr = VecRestoreArray(x, &xv);CHKERRQ(ierr);
+
+  return 0;
+}
+
+/* corrections of the last solves, newest first, for the warm start */
+static Vec history[2];
+static double history_t[2];
+static int history_count = 0;
+
+/* seeds x with the last correction, or with the last two extrapolated
+ * linearly to this timestep, or leaves the solve starting from zero */
+static int vof_pressure_gmres_guess(struct solver_data *solver, KSP ksp, Vec x) {
+  PetscErrorCode ierr;
+  double r;
+
+  if(solver->pressure_warm_start < 1 || history_count < 1) {
+    ierr = KSPSetInitialGuessNonzero(ksp, PETSC_FALSE);CHKERRQ(ierr);
+    return 0;
+  }
+
+  ierr = VecCopy(history[0], x);CHKERRQ(ierr);
+  if(solver->pressure_warm_start > 1 && history_count > 1 && history_t[0] > history_t[1]) {
+    /* a repeated step after deltcal shrank delt gets r = 0 */
+    r = (solver->t - history_t[0]) / (history_t[0] - history_t[1]);
+    ierr = VecAXPBY(x, -r, 1 + r, history[1]);CHKERRQ(ierr);
+  }
+  ierr = KSPSetInitialGuessNonzero(ksp, PETSC_TRUE);CHKERRQ(ierr);
+
+  return 0;
+}
+
+/* keeps the correction just solved for, or forgets them all when the
+ * solve failed */
+static int vof_pressure_gmres_store(struct solver_data *solver, Vec x, KSPConvergedReason reason) {
+  PetscErrorCode ierr;
+  Vec swap;
+  int n;
+
+  if(solver->pressure_warm_start < 1) return 0;
+
+  if(reason < 0) {
+    history_count = 0;
+    return 0;
+  }
+
+  for(n = 0; n < solver->pressure_warm_start && n < 2; n++) {
+    if(history[n] == NULL) {
+      ierr = VecDuplicate(x, &history[n]);CHKERRQ(ierr);
+    }
+  }
+
+  if(solver->pressure_warm_start > 1) {
+    swap = history[1];
+    history[1] = history[0];
+    history[0] = swap;
+    history_t[1] = history_t[0];
+  }
+  ierr = VecCopy(x, history[0]);CHKERRQ(ierr);
+  history_t[0] = solver->t;
+  if(history_count < solver->pressure_warm_start && history_count < 2) history_count++;
+
+  return 0;
+}
+
 int vof_pressure_gmres_mpi(struct solver_data *solver) {
 	PetscInt i,j,k,size;
 	PetscInt	iter;
@@ -726,35 +1234,35 @@ int vof_pressure_gmres_mpi(struct solver_data *solver) {
 	static Vec x, b;
 	static Mat A;
   static KSP  ksp;         /* linear solver context */
-  static PC  pc;           /* preconditioner context */
-  KSP *subksp;
-  PC subpc;
   KSPConvergedReason reason;
   static int initialize = 0;
+  static long int last_iter = 0;
   int offset = 1;
   int range;
   int Istart, Iend;
   int Cstart, Cend;
-  static int nlocal, first;
-  int *blks;
-  double *results;
+  double *results, t_start, t_setup, t_reduce, memory;
+  MatInfo info;
   IS diag_zeros;
   
-  range = IRANGE-1;
-  if(solver->rank < solver->size - 1 && solver->rank > 0) {
-    range--;
-  }
+  /* locally owned planes, without the halo plane on either side */
+  range = IRANGE;
+  if(!solver_mpi_wall(solver, 0)) range--;
+  if(!solver_mpi_wall(solver, 1)) range--;
+
+  t_start = MPI_Wtime();
 
 	if(!initialize) {
-    //PetscLogBegin();
+    ierr = PetscLogDefaultBegin();CHKERRQ(ierr);
 	  size = IMAX * JMAX * KMAX;
     
-    ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
-    ierr = MatSetSizes(A,range * JMAX * KMAX,range * JMAX * KMAX,size,size);CHKERRQ(ierr);
-    ierr = MatSetType(A,MATMPIAIJ);CHKERRQ(ierr);
-    ierr = MatSetOption(A,MAT_IGNORE_OFF_PROC_ENTRIES,PETSC_TRUE);CHKERRQ(ierr);
-    ierr = MatMPIAIJSetPreallocation(A, 7, PETSC_NULL, 7, PETSC_NULL);CHKERRQ(ierr);
-    ierr = MatSeqAIJSetPreallocation(A,7,NULL); CHKERRQ(ierr);
+    if(solver->pressure_matrix_free) {
+      if(vof_pressure_shell_create(solver, range, &A)) return 1;
+    }
+    else {
+      if(vof_pressure_csr_create(solver, range, &A)) return 1;
+    }
+    if(vof_pressure_lines(solver) && vof_pressure_line_init(solver, A, range)) return 1;
     ierr = MatGetOwnershipRange(A,&Istart,&Iend);
     ierr = MatGetOwnershipRangeColumn(A,&Cstart,&Cend);
     ierr = VecCreateMPI(PETSC_COMM_WORLD,range * JMAX * KMAX,size,&x);CHKERRQ(ierr);
@@ -763,80 +1271,123 @@ int vof_pressure_gmres_mpi(struct solver_data *solver) {
     ierr = VecSetOption(b, VEC_IGNORE_OFF_PROC_ENTRIES, PETSC_TRUE);CHKERRQ(ierr);
     
     ierr = KSPCreate(PETSC_COMM_WORLD,&ksp);CHKERRQ(ierr);
+    ierr = vof_pressure_gmres_ksp(solver, ksp);CHKERRQ(ierr);
     
+    ierr = vof_pressure_begin(solver, A);CHKERRQ(ierr);
     vof_pressure_gmres_assemble(solver, A, b);
     vof_pressure_gmres_boundary_edges(solver, A, b); 
     vof_pressure_gmres_boundary(solver, A, b); 
-    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
-    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+    if(vof_pressure_symmetric(solver) && vof_pressure_gmres_fold(solver)) return 1;
+    ierr = vof_pressure_end(solver, A);CHKERRQ(ierr);
+    ierr = VecAssemblyBegin(b);CHKERRQ(ierr);
+    ierr = VecAssemblyEnd(b);CHKERRQ(ierr);
+    if(vof_pressure_symmetric(solver)) {
+      ierr = vof_pressure_gmres_eliminate(solver, A, b);CHKERRQ(ierr);
+    }
 		initialize = 1;
     
 #ifdef DEBUG
-    MatFindZeroDiagonals(A, &diag_zeros);
+    if(!solver->pressure_matrix_free) MatFindZeroDiagonals(A, &diag_zeros);
     printf("Checking for non-zero diagonals:\n");
     ISView(diag_zeros, PETSC_VIEWER_STDOUT_WORLD);
 #endif
 
 
-    ierr = KSPSetOperators(ksp,A,A);CHKERRQ(ierr);
-    ierr = KSPGetPC(ksp,&pc);CHKERRQ(ierr);
-    ierr = PCSetType(pc,PCBJACOBI);CHKERRQ(ierr);
-
-    //PCASMSetLocalSubdomains(pc, range, NULL, NULL);
-    //PCASMSetOverlap(pc, KMAX);
-    
-    ierr = PetscMalloc1(range,&blks);CHKERRQ(ierr);
-    for (i=0; i<range; i++) blks[i] = JMAX * KMAX;
-    ierr = PCBJacobiSetLocalBlocks(pc,range,blks);CHKERRQ(ierr);
-    ierr = PetscFree(blks);
-
-    ierr = KSPSetUp(ksp); CHKERRQ(ierr);
-    //ierr = KSPSetType(ksp,KSPGMRES); CHKERRQ(ierr);
+    if(solver->pressure_active_only && solver->pressure_matrix_free && !solver->rank)
+      printf("warning: pressure_active_only needs the assembled matrix, solving over every cell\n");
 
     ierr = KSPSetTolerances(ksp,solver->reltol,solver->abstol,PETSC_DEFAULT,solver->niter);CHKERRQ(ierr);
-    //ierr = PCASMGetSubKSP(pc,&nlocal,&first,&subksp);CHKERRQ(ierr);
-    ierr = PCBJacobiGetSubKSP(pc,&nlocal,&first,&subksp);CHKERRQ(ierr);
-    for (i=0; i<nlocal; i++) {
-      ierr = KSPGetPC(subksp[i],&subpc);CHKERRQ(ierr);
-      ierr = PCSetType(subpc,PCSOR);CHKERRQ(ierr);
-      ierr = PCSORSetOmega(subpc, 1.0);
-      ierr = KSPSetType(subksp[i],KSPPREONLY);CHKERRQ(ierr);
-      ierr = KSPSetTolerances(subksp[i],solver->reltol,solver->abstol,PETSC_DEFAULT,solver->niter);CHKERRQ(ierr);
+    t_setup = MPI_Wtime();
+    if(vof_pressure_active(solver)) {
+      ierr = vof_pressure_gmres_active(solver, ksp, A, b, range);CHKERRQ(ierr);
     }
+    else {
+      ierr = KSPSetOperators(ksp,A,A);CHKERRQ(ierr);
+      ierr = vof_pressure_gmres_pc(solver, ksp, A, range, NULL);CHKERRQ(ierr);
+    }
+    solver->pressure_setup_time = MPI_Wtime() - t_setup;
 
-    printf("Built matrix with range: %d to %d on proc %d\n",Istart, Iend, solver->rank);
+    if(solver->pressure_matrix_free) {
+      memory = vof_pressure_shell_memory(A);
+    }
+    else {
+      ierr = MatGetInfo(A,MAT_LOCAL,&info);CHKERRQ(ierr);
+      memory = info.memory;
+    }
+    printf("Built matrix with range: %d to %d on proc %d, %.1lf MB\n",Istart, Iend, solver->rank,
+           memory / 1048576);
 
 	}
   else {
+    ierr = vof_pressure_begin(solver, A);CHKERRQ(ierr);
     vof_pressure_gmres_update(solver, A, b);  
     vof_pressure_gmres_boundary(solver, A, b); 
-    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
-    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+    if(vof_pressure_symmetric(solver) && vof_pressure_gmres_fold(solver)) return 1;
+    ierr = vof_pressure_end(solver, A);CHKERRQ(ierr);
+    ierr = VecAssemblyBegin(b);CHKERRQ(ierr);
+    ierr = VecAssemblyEnd(b);CHKERRQ(ierr);
+    if(vof_pressure_symmetric(solver)) {
+      ierr = vof_pressure_gmres_eliminate(solver, A, b);CHKERRQ(ierr);
+    }
+
+    t_setup = MPI_Wtime();
+    if(vof_pressure_active(solver)) {
+      ierr = vof_pressure_gmres_active(solver, ksp, A, b, range);CHKERRQ(ierr);
+    }
+
+    /* the preconditioner is rebuilt here, unless it is kept */
+    ierr = KSPSetReusePreconditioner(ksp, vof_pressure_gmres_reuse(solver, last_iter) ? PETSC_TRUE : PETSC_FALSE);CHKERRQ(ierr);
+    ierr = KSPSetUp(ksp);CHKERRQ(ierr);
+    solver->pressure_setup_time = MPI_Wtime() - t_setup;
   }
   
 
   /* vof_pressure_gmres_write(A,solver->t); */
   
-  ierr = VecAssemblyBegin(b);CHKERRQ(ierr);
-  ierr = VecAssemblyEnd(b);CHKERRQ(ierr);
-  
   
   /*
      Solve linear system
   */
 
 	/* ierr = KSPMonitorSet(ksp, KSPMonitorDefault, NULL, NULL); */ 
-  ierr = KSPSolve(ksp,b,x);CHKERRQ(ierr);
+  t_reduce = vof_pressure_gmres_reductions();
+  ierr = vof_pressure_gmres_guess(solver, ksp, x);CHKERRQ(ierr);
+  ierr = vof_pressure_gmres_solve(solver, ksp, b, x);CHKERRQ(ierr);
     
   ierr = KSPGetResidualNorm(ksp, &solver->resimax);CHKERRQ(ierr);
   ierr = KSPGetIterationNumber(ksp, &iter);CHKERRQ(ierr);
   solver->iter = iter;
   
   KSPGetConvergedReason(ksp,&reason);
+
+  /* multigrid can break down on a badly scaled system, fall back to
+   * block jacobi for the rest of the run and solve again */
+  if(reason < 0 && reason != KSP_DIVERGED_ITS && solver->pressure_pc != pressure_pc_bjacobi) {
+    if(!solver->rank) 
+      printf("warning: pressure solve diverged (%s), falling back to block jacobi\n", 
+             KSPConvergedReasons[reason]);
+    solver->pressure_pc = pressure_pc_bjacobi;
+    ierr = KSPSetReusePreconditioner(ksp, PETSC_FALSE);CHKERRQ(ierr);
+    ierr = vof_pressure_gmres_pc_reset(solver, ksp, A, range);CHKERRQ(ierr);
+    ierr = vof_pressure_gmres_guess(solver, ksp, x);CHKERRQ(ierr);
+    ierr = vof_pressure_gmres_solve(solver, ksp, b, x);CHKERRQ(ierr);
+
+    ierr = KSPGetResidualNorm(ksp, &solver->resimax);CHKERRQ(ierr);
+    ierr = KSPGetIterationNumber(ksp, &iter);CHKERRQ(ierr);
+    solver->iter = iter;
+    KSPGetConvergedReason(ksp,&reason);
+  }
+  ierr = vof_pressure_gmres_store(solver, x, reason);CHKERRQ(ierr);
+  solver->pressure_time = MPI_Wtime() - t_start;
+  solver->pressure_reduce_time = vof_pressure_gmres_reductions() - t_reduce;
+  solver->pressure_iter_total += iter;
+  solver->pressure_solves++;
+  last_iter = iter;
+
   solver->conv_reason = reason;
   sprintf(solver->conv_reason_str, "%s", KSPConvergedReasons[reason]);
 
-  if(!solver->rank) offset = 0;
+  if(solver_mpi_wall(solver, 0)) offset = 0;
   VecGetArray(x,&results);
   for(i=1; i<IRANGE-1; i++) {
     for(j=1; j<JMAX-1; j++) {
@@ -846,7 +1397,7 @@ int vof_pressure_gmres_mpi(struct solver_data *solver) {
 
         if(VOF(i,j,k) < emf) continue;
         
-        delp = results[mesh_index(solver->mesh,i-offset,j,k)];        
+        delp = results[mesh_offset(solver->mesh,i-offset,j,k)];        
         P(i,j,k) += delp;
 
         if(AE(i,j,k) > emf && i+ISTART < IMAX-1)
@@ -873,9 +1424,9 @@ int vof_pressure_gmres_mpi(struct solver_data *solver) {
       solver->mesh->delu_downstream[KMAX * j + k] = 0;
       if(FV(i,j,k)>emf && VOF(i,j,k) > emf) {
 
-        /*n = mesh_index(solver->mesh,i+ISTART,j,k);
+        /*n = mesh_offset(solver->mesh,i+ISTART,j,k);
         ierr = VecGetValues(x,1,&n,&delp); CHKERRQ(ierr);*/
-        delp = results[mesh_index(solver->mesh,i-offset,j,k)]; 
+        delp = results[mesh_offset(solver->mesh,i-offset,j,k)]; 
         
         if(AE(i,j,k) > emf && i+ISTART < IMAX-2)
           solver->mesh->delu_downstream[KMAX * j + k] = solver->delt* RDX * delp / (solver->rho /* AE(i,j,k) */);
@@ -885,9 +1436,9 @@ int vof_pressure_gmres_mpi(struct solver_data *solver) {
       solver->mesh->delu_upstream[KMAX * j + k] = 0;
       if(FV(i,j,k)>emf && VOF(i,j,k) > emf) {
 
-        /*n = mesh_index(solver->mesh,i+ISTART,j,k);
+        /*n = mesh_offset(solver->mesh,i+ISTART,j,k);
         ierr = VecGetValues(x,1,&n,&delp); CHKERRQ(ierr);*/
-        delp = results[mesh_index(solver->mesh,i-offset,j,k)]; 
+        delp = results[mesh_offset(solver->mesh,i-offset,j,k)]; 
         
         if(AE(i-1,j,k) > emf && i+ISTART > 1)
           solver->mesh->delu_upstream[KMAX * j + k] = -1 * solver->delt* RDX * delp / (solver->rho /* AE(i-1,j,k) */);
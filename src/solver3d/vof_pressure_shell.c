@@ -0,0 +1,300 @@
+/* vof_pressure_shell.c
+ *
+ * matrix-free operator for the pressure solve.  interior rows are the
+ * 7-point stencil, rebuilt from the fractional areas on every product.
+ * free surface, void and boundary rows keep a diagonal and at most one
+ * neighbour coefficient, set through the same calls that fill the
+ * assembled matrix
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include <petscmat.h>
+
+#include "solver.h"
+#include "solver_mpi.h"
+#include "mesh.h"
+#include "vof_pressure_shell.h"
+
+#include "vof_macros.h"
+
+#define SHELL_STENCIL -1
+
+struct vof_pressure_shell {
+  struct solver_data *solver;
+  long int first;      /* first owned local plane */
+  long int rows;       /* owned rows */
+  PetscInt row_start;  /* global index of the first owned row */
+  double rdx2, rdy2, rdz2; /* 1 / (rho del^2) */
+
+  double *diag;
+  double *off;
+  signed char *dir;    /* neighbour of off, as the column of row_idx, or SHELL_STENCIL */
+  double *x;           /* the vector being multiplied, with halo planes */
+};
+
+/* the neighbour a column lies in, numbered as in row_idx of the assembly */
+static int vof_pressure_shell_dir(struct solver_data *solver, PetscInt delta) {
+  if(delta ==  JMAX * KMAX) return 1;
+  if(delta == -JMAX * KMAX) return 2;
+  if(delta ==  KMAX) return 3;
+  if(delta == -KMAX) return 4;
+  if(delta ==  1) return 5;
+  if(delta == -1) return 6;
+
+  return 0;
+}
+
+static PetscErrorCode vof_pressure_shell_mult(Mat A, Vec x, Vec y) {
+  struct vof_pressure_shell *shell;
+  struct solver_data *solver;
+  struct mesh_view view;
+  const PetscScalar *xv;
+  PetscScalar *yv;
+  PetscErrorCode ierr;
+  long int n, l, step[7];
+  double *xs, *ae, *an, *at, sum;
+
+  ierr = MatShellGetContext(A, &shell);CHKERRQ(ierr);
+  solver = shell->solver;
+  view = mesh_view(solver->mesh, shell->x);
+  xs = shell->x;
+  ae = solver->mesh->ae;
+  an = solver->mesh->an;
+  at = solver->mesh->at;
+
+  step[0] = 0;
+  step[1] = view.si;
+  step[2] = -view.si;
+  step[3] = view.sj;
+  step[4] = -view.sj;
+  step[5] = 1;
+  step[6] = -1;
+
+  /* neighbours across the slab boundary come from the halo planes */
+  ierr = VecGetArrayRead(x, &xv);CHKERRQ(ierr);
+  memcpy(xs + shell->first * view.si, xv, sizeof(double) * shell->rows);
+  ierr = VecRestoreArrayRead(x, &xv);CHKERRQ(ierr);
+  solver_sendrecv_edge(solver, xs);
+
+  ierr = VecGetArray(y, &yv);CHKERRQ(ierr);
+
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(n, l, sum) schedule(static)
+  for(n = 0; n < shell->rows; n++) {
+    l = n + shell->first * view.si;
+
+    if(shell->dir[n] == SHELL_STENCIL) {
+      sum  = shell->rdx2 * (ae[l] * (xs[l + view.si] - xs[l]) + ae[l - view.si] * (xs[l - view.si] - xs[l]));
+      sum += shell->rdy2 * (an[l] * (xs[l + view.sj] - xs[l]) + an[l - view.sj] * (xs[l - view.sj] - xs[l]));
+      sum += shell->rdz2 * (at[l] * (xs[l + 1] - xs[l]) + at[l - 1] * (xs[l - 1] - xs[l]));
+      yv[n] = sum;
+      continue;
+    }
+
+    yv[n] = shell->diag[n] * xs[l];
+    if(shell->dir[n] > 0) yv[n] += shell->off[n] * xs[l + step[(int) shell->dir[n]]];
+  }
+
+  ierr = VecRestoreArray(y, &yv);CHKERRQ(ierr);
+
+  return 0;
+}
+
+static PetscErrorCode vof_pressure_shell_diagonal(Mat A, Vec d) {
+  struct vof_pressure_shell *shell;
+  struct solver_data *solver;
+  struct mesh_view view;
+  PetscScalar *dv;
+  PetscErrorCode ierr;
+  long int n, l;
+  double *ae, *an, *at;
+
+  ierr = MatShellGetContext(A, &shell);CHKERRQ(ierr);
+  solver = shell->solver;
+  view = mesh_view(solver->mesh, shell->x);
+  ae = solver->mesh->ae;
+  an = solver->mesh->an;
+  at = solver->mesh->at;
+
+  ierr = VecGetArray(d, &dv);CHKERRQ(ierr);
+  for(n = 0; n < shell->rows; n++) {
+    l = n + shell->first * view.si;
+
+    if(shell->dir[n] == SHELL_STENCIL)
+      dv[n] = -1.0 * (shell->rdx2 * (ae[l] + ae[l - view.si]) +
+                      shell->rdy2 * (an[l] + an[l - view.sj]) +
+                      shell->rdz2 * (at[l] + at[l - 1]));
+    else
+      dv[n] = shell->diag[n];
+  }
+  ierr = VecRestoreArray(d, &dv);CHKERRQ(ierr);
+
+  return 0;
+}
+
+/* creates the operator over the planes owned by this process.  every row
+ * starts empty, as in a freshly preallocated matrix */
+int vof_pressure_shell_create(struct solver_data *solver, long int planes, Mat *A) {
+  struct vof_pressure_shell *shell;
+  PetscInt size, row_end;
+  PetscErrorCode ierr;
+  long int cells;
+
+  shell = malloc(sizeof(struct vof_pressure_shell));
+  if(shell == NULL) {
+    printf("error: could not allocate the matrix-free pressure operator\n");
+    return 1;
+  }
+
+  shell->solver = solver;
+  shell->first = solver_mpi_wall(solver, 0) ? 0 : 1;
+  shell->rows = planes * JMAX * KMAX;
+  shell->rdx2 = 1/solver->rho * 1/pow(DELX,2);
+  shell->rdy2 = 1/solver->rho * 1/pow(DELY,2);
+  shell->rdz2 = 1/solver->rho * 1/pow(DELZ,2);
+
+  cells = IRANGE * JMAX * KMAX;
+  shell->diag = calloc(shell->rows, sizeof(double));
+  shell->off  = calloc(shell->rows, sizeof(double));
+  shell->dir  = calloc(shell->rows, sizeof(signed char));
+  shell->x    = calloc(cells, sizeof(double));
+  if(shell->diag == NULL || shell->off == NULL || shell->dir == NULL || shell->x == NULL) {
+    printf("error: could not allocate the matrix-free pressure operator\n");
+    free(shell->diag);
+    free(shell->off);
+    free(shell->dir);
+    free(shell->x);
+    free(shell);
+    return 1;
+  }
+
+  size = IMAX * JMAX * KMAX;
+  ierr = MatCreateShell(PETSC_COMM_WORLD, shell->rows, shell->rows, size, size, shell, A);CHKERRQ(ierr);
+  ierr = MatShellSetOperation(*A, MATOP_MULT, (void (*)(void)) vof_pressure_shell_mult);CHKERRQ(ierr);
+  ierr = MatShellSetOperation(*A, MATOP_GET_DIAGONAL, (void (*)(void)) vof_pressure_shell_diagonal);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(*A, &shell->row_start, &row_end);CHKERRQ(ierr);
+
+  return 0;
+}
+
+/* the equivalent of MatSetValue with INSERT_VALUES.  rows of other
+ * processes are ignored, as with MAT_IGNORE_OFF_PROC_ENTRIES */
+int vof_pressure_shell_set(Mat A, PetscInt row, PetscInt col, PetscScalar value) {
+  struct vof_pressure_shell *shell;
+  PetscErrorCode ierr;
+  long int n;
+  int dir;
+
+  ierr = MatShellGetContext(A, &shell);CHKERRQ(ierr);
+
+  n = row - shell->row_start;
+  if(n < 0 || n >= shell->rows) return 0;
+
+  if(col == row) {
+    shell->diag[n] = value;
+    return 0;
+  }
+
+  dir = vof_pressure_shell_dir(shell->solver, col - row);
+  if(value != 0) {
+    shell->dir[n] = dir;
+    shell->off[n] = value;
+  }
+  else if(shell->dir[n] == dir) {
+    shell->off[n] = 0;
+  }
+
+  return 0;
+}
+
+/* marks an interior row, whose coefficients come from the fractional areas */
+int vof_pressure_shell_set_stencil(Mat A, PetscInt row) {
+  struct vof_pressure_shell *shell;
+  PetscErrorCode ierr;
+  long int n;
+
+  ierr = MatShellGetContext(A, &shell);CHKERRQ(ierr);
+
+  n = row - shell->row_start;
+  if(n < 0 || n >= shell->rows) return 0;
+
+  shell->dir[n] = SHELL_STENCIL;
+  shell->off[n] = 0;
+
+  return 0;
+}
+
+/* empties a row before it is written in full */
+int vof_pressure_shell_clear(Mat A, PetscInt row) {
+  struct vof_pressure_shell *shell;
+  PetscErrorCode ierr;
+  long int n;
+
+  ierr = MatShellGetContext(A, &shell);CHKERRQ(ierr);
+
+  n = row - shell->row_start;
+  if(n < 0 || n >= shell->rows) return 0;
+
+  shell->dir[n] = 0;
+  shell->diag[n] = 0;
+  shell->off[n] = 0;
+
+  return 0;
+}
+
+/* the coefficients along the k-line of each owned row, and to the rows of
+ * the next and previous j-lines of the same plane */
+int vof_pressure_shell_lines(Mat A, double *lower, double *diag, double *upper, double *south, double *north) {
+  struct vof_pressure_shell *shell;
+  struct solver_data *solver;
+  struct mesh_view view;
+  PetscErrorCode ierr;
+  long int n, l;
+  double *ae, *an, *at;
+
+  ierr = MatShellGetContext(A, &shell);CHKERRQ(ierr);
+  solver = shell->solver;
+  view = mesh_view(solver->mesh, shell->x);
+  ae = solver->mesh->ae;
+  an = solver->mesh->an;
+  at = solver->mesh->at;
+
+  for(n = 0; n < shell->rows; n++) {
+    l = n + shell->first * view.si;
+
+    if(shell->dir[n] == SHELL_STENCIL) {
+      diag[n] = -1.0 * (shell->rdx2 * (ae[l] + ae[l - view.si]) +
+                        shell->rdy2 * (an[l] + an[l - view.sj]) +
+                        shell->rdz2 * (at[l] + at[l - 1]));
+      lower[n] = shell->rdz2 * at[l - 1];
+      upper[n] = shell->rdz2 * at[l];
+      south[n] = shell->rdy2 * an[l - view.sj];
+      north[n] = shell->rdy2 * an[l];
+      continue;
+    }
+
+    diag[n] = shell->diag[n];
+    lower[n] = (shell->dir[n] == 6) ? shell->off[n] : 0;
+    upper[n] = (shell->dir[n] == 5) ? shell->off[n] : 0;
+    south[n] = (shell->dir[n] == 4) ? shell->off[n] : 0;
+    north[n] = (shell->dir[n] == 3) ? shell->off[n] : 0;
+  }
+
+  return 0;
+}
+
+/* bytes held by the operator on this process */
+long int vof_pressure_shell_memory(Mat A) {
+  struct vof_pressure_shell *shell;
+  struct solver_data *solver;
+
+  if(MatShellGetContext(A, &shell)) return 0;
+  solver = shell->solver;
+
+  return shell->rows * (2 * sizeof(double) + sizeof(signed char)) +
+         IRANGE * JMAX * KMAX * sizeof(double);
+}
@@ -0,0 +1,19 @@
+/* vof_pressure_shell.h
+ *
+ * matrix-free operator for the pressure solve
+ */
+
+#ifndef VOF_PRESSURE_SHELL_H
+#define VOF_PRESSURE_SHELL_H
+
+#include <petscmat.h>
+#include "solver_data.h"
+
+int vof_pressure_shell_create(struct solver_data *solver, long int planes, Mat *A);
+int vof_pressure_shell_set(Mat A, PetscInt row, PetscInt col, PetscScalar value);
+int vof_pressure_shell_set_stencil(Mat A, PetscInt row);
+int vof_pressure_shell_clear(Mat A, PetscInt row);
+int vof_pressure_shell_lines(Mat A, double *lower, double *diag, double *upper, double *south, double *north);
+long int vof_pressure_shell_memory(Mat A);
+
+#endif
@@ -21,6 +21,7 @@
 #include "vof_baffles.h"
 #include "mesh_mpi.h"
 #include "solver_mpi.h"
+#include "vof_viscosity.h"
 
 #include "vof_macros.h"
 
@@ -32,8 +33,9 @@ int vof_mpi_velocity_upwind(struct solver_data *solver) {
   double af[3][27];
   double vis[3];
   double Flux, Viscocity, Q_C, Q_W, H_vel, upwind, sum_fv, delp, delv, nu;
+  double nu_max = solver->nu_max;
 
-  long int i,j,k;
+  long int i,j,k,l,ln;
   int n,m,o;
 
 #define dim(i,j,k) i+3*(j+k*3)
@@ -46,15 +48,39 @@ int vof_mpi_velocity_upwind(struct solver_data *solver) {
 
   const double del[3] = { DELX, DELY, DELZ };
 
-  for(i=1; i<IRANGE-1; i++) {
-    for(j=1; j<JMAX-1; j++) {
-      for(k=1; k<KMAX-1; k++) {
-
-        U(i,j,k) = 0;
-        V(i,j,k) = 0;
-        W(i,j,k) = 0;
+  /* all arrays share the same layout, so one offset per cell serves every field */
+  const struct mesh_view view = mesh_view(solver->mesh, solver->mesh->u);
+  const long int off[3] = { view.si, view.sj, 1 };
+  double * const u = solver->mesh->u;
+  double * const v = solver->mesh->v;
+  double * const w = solver->mesh->w;
+  const double * const un = mesh_n->u;
+  const double * const vn = mesh_n->v;
+  const double * const wn = mesh_n->w;
+  const double * const ae = solver->mesh->ae;
+  const double * const an = solver->mesh->an;
+  const double * const at = solver->mesh->at;
+  const double * const fv = solver->mesh->fv;
+  const double * const vof = solver->mesh->vof;
+  const double * const p = solver->mesh->P;
+  const long int irange = IRANGE, jmax = JMAX, kmax = KMAX;
+
+  /* every cell only writes its own u, v, w and reads the previous timestep, 
+   * so the threaded loop gives the same result as the serial one */
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(i, j, k, l, ln, n, m, o, vel, af, vis, Flux, Viscocity, Q_C, Q_W, H_vel, upwind, \
+            sum_fv, delp, delv, nu, ro_p1, ro_m1, ro_mp1, ro_mm1, ro_nmm1) \
+    reduction(max:nu_max) schedule(static)
+  for(i=1; i<irange-1; i++) {
+    for(j=1; j<jmax-1; j++) {
+      for(k=1; k<kmax-1; k++) {
+        l = MESH_VIEW_OFFSET(view, i, j, k);
+
+        u[l] = 0;
+        v[l] = 0;
+        w[l] = 0;
           
-        if (FV(i,j,k) == 0.0) continue;
+        if (fv[l] == 0.0) continue;
 
         for(m=0; m<3; m++) { /* fixed 6/16 from n,m,o */
           for(n=0; n<3; n++) {
@@ -67,13 +93,15 @@ int vof_mpi_velocity_upwind(struct solver_data *solver) {
                * this caches the data and allows the velocity predictor
                * calcs to be generalized */
 
-              vel[0][dim(m,n,o)] = UN(i-1+m,j-1+n,k-1+o);
-              vel[1][dim(m,n,o)] = VN(i-1+m,j-1+n,k-1+o);
-              vel[2][dim(m,n,o)] = WN(i-1+m,j-1+n,k-1+o);
+              ln = l + (m-1) * view.si + (n-1) * view.sj + (o-1);
+
+              vel[0][dim(m,n,o)] = un[ln];
+              vel[1][dim(m,n,o)] = vn[ln];
+              vel[2][dim(m,n,o)] = wn[ln];
 
-              af[0][dim(m,n,o)] = AE(i-1+m,j-1+n,k-1+o);
-              af[1][dim(m,n,o)] = AN(i-1+m,j-1+n,k-1+o);
-              af[2][dim(m,n,o)] = AT(i-1+m,j-1+n,k-1+o);
+              af[0][dim(m,n,o)] = ae[ln];
+              af[1][dim(m,n,o)] = an[ln];
+              af[2][dim(m,n,o)] = at[ln];
             }
           }
         }
@@ -83,18 +111,20 @@ int vof_mpi_velocity_upwind(struct solver_data *solver) {
           /* ADDED 9/12 to eliminate pointless calcs that mess things up */
           if(af[n][ro] < solver->emf) continue;
 
-          if(VOF(i,j,k) + VOF(i+odim[n][0],j+odim[n][1],k+odim[n][2]) < solver->emf /*
+          ln = l + off[n];
+
+          if(vof[l] + vof[ln] < solver->emf /*
              || (N_VOF(i,j,k) >  7 && N_VOF(i+odim[n][0],j+odim[n][1],k+odim[n][2]) > 0)
              || (N_VOF(i,j,k) >  0 && N_VOF(i+odim[n][0],j+odim[n][1],k+odim[n][2]) > 7) */) { /* added 09/13 */
             switch(n) {
             case 0:
-              U(i,j,k) = 0;
+              u[l] = 0;
               break;
             case 1:
-              V(i,j,k) = 0;
+              v[l] = 0;
               break;
             case 2:
-              W(i,j,k) = 0;
+              w[l] = 0;
               break;
             }        
             continue; 
@@ -228,9 +258,9 @@ int vof_mpi_velocity_upwind(struct solver_data *solver) {
 
           }
 
-          sum_fv = (FV(i,j,k) + FV(i+odim[n][0],j+odim[n][1],k+odim[n][2]));
-          delp   = (P(i,j,k)  -  P(i+odim[n][0],j+odim[n][1],k+odim[n][2]));
-          if(FV(i+odim[n][0],j+odim[n][1],k+odim[n][2]) < 0.000001) delp=0; /* ADDED 2/27/16 testing */
+          sum_fv = (fv[l] + fv[ln]);
+          delp   = (p[l]  -  p[ln]);
+          if(fv[ln] < 0.000001) delp=0; /* ADDED 2/27/16 testing */
 
           Flux = (Q_C + Q_W) / sum_fv;
           
@@ -240,10 +270,14 @@ int vof_mpi_velocity_upwind(struct solver_data *solver) {
           }
           else
             nu = solver->nu;
-          solver->nu_max = max(nu, solver->nu_max);
+          nu_max = max(nu, nu_max);
                  
-          Viscocity = nu * (vis[0]/pow(del[0],2) + vis[1]/pow(del[1],2) + vis[2]/pow(del[2],2));
-          Viscocity = Viscocity / (sum_fv / 2); // ADDED 03/27/18 and testing
+          /* the implicit step adds the viscous term after this loop */
+          if(solver->viscous_implicit) Viscocity = 0;
+          else {
+            Viscocity = nu * (vis[0]/pow(del[0],2) + vis[1]/pow(del[1],2) + vis[2]/pow(del[2],2));
+            Viscocity = Viscocity / (sum_fv / 2); // ADDED 03/27/18 and testing
+          }
 
           /* deleted from this code 6/18
            * sum_fv/2 * delp: this created discontinuity at pressure boundaries */
@@ -257,13 +291,13 @@ int vof_mpi_velocity_upwind(struct solver_data *solver) {
 
           switch(n) {
           case 0:
-            if(i != IMAX-2)  U(i,j,k) = UN(i,j,k) + delv;
+            if(i != IMAX-2)  u[l] = un[l] + delv;
             break;
           case 1:
-            if(j != JMAX-2)  V(i,j,k) = VN(i,j,k) + delv;
+            if(j != jmax-2)  v[l] = vn[l] + delv;
             break;
           case 2:
-            if(k != KMAX-2)  W(i,j,k) = WN(i,j,k) + delv;
+            if(k != kmax-2)  w[l] = wn[l] + delv;
             break;
           }
           
@@ -274,6 +308,10 @@ int vof_mpi_velocity_upwind(struct solver_data *solver) {
     }
   }
 
+  solver->nu_max = nu_max;
+
+  if(solver->viscous_implicit) return vof_viscosity_implicit(solver);
+
   return 0;
 #undef dim
  }
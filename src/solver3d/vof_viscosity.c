@@ -0,0 +1,259 @@
+/* vof_viscosity.c
+ *
+ * semi-implicit viscous step of the velocity predictor.  with
+ * viscous_implicit the predictor leaves out the viscous term, and each
+ * velocity component is then found from
+ *
+ *   u - delt * nu * lap(u) = u_predicted
+ *
+ * with the same fractional area weighted laplacian the explicit term uses.
+ * neighbours that are not solved for keep their value from the previous
+ * timestep, as in the explicit term.  the system is relaxed with lines
+ * solved exactly along k, gauss-seidel along j and the i planes taken
+ * red-black, exchanging the halo planes after every sweep.  there is no
+ * stability limit on delt * nu, so deltcal only keeps the convective one
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <omp.h>
+#include <mpi.h>
+
+#include "solver.h"
+#include "mesh.h"
+#include "solver_mpi.h"
+#include "vof_viscosity.h"
+
+#include "vof_macros.h"
+
+extern struct mesh_data *mesh_n; /* describes mesh at previous timestep for explicit calcs */
+
+/* per cell coefficients of one component */
+enum viscous_coefs { visc_east, visc_west, visc_north, visc_south, visc_top, visc_bottom,
+                     visc_diag, visc_rhs, visc_count };
+
+struct vof_viscosity {
+  long int size;
+  double *coef;  /* visc_count values per cell, visc_diag 0 where the cell is not solved for */
+  double *x;     /* the component being solved, over the whole local mesh */
+  double *cp;    /* thomas factors and forward values, 2 * kmax per thread */
+};
+
+static struct vof_viscosity visc;
+
+static int vof_viscosity_alloc(struct solver_data *solver) {
+  const long int size = IRANGE * JMAX * KMAX;
+
+  if(visc.size == size) return 0;
+
+  free(visc.coef);
+  free(visc.x);
+  free(visc.cp);
+  visc.coef = malloc(sizeof(double) * size * visc_count);
+  visc.x = malloc(sizeof(double) * size);
+  visc.cp = malloc(sizeof(double) * 2 * KMAX * max(solver->threads, 1));
+  if(visc.coef == NULL || visc.x == NULL || visc.cp == NULL) {
+    printf("error: could not allocate the implicit viscous step\n");
+    visc.size = 0;
+    return 1;
+  }
+  visc.size = size;
+
+  return 0;
+}
+
+/* fills the coefficients of component n, with the predicted velocity as
+ * the right hand side, and seeds x with it */
+static void vof_viscosity_coef(struct solver_data *solver, int n, const double *vel, const double *vel_n) {
+  const struct mesh_view view = mesh_view(solver->mesh, solver->mesh->u);
+  const long int off[3] = { view.si, view.sj, 1 };
+  const double del[3] = { DELX, DELY, DELZ };
+  const int odim[3][3] = { {  1,0,0 }, { 0,1,0 }, { 0,0,1 } };
+  const double * const af[3] = { solver->mesh->ae, solver->mesh->an, solver->mesh->at };
+  const double * const fv = solver->mesh->fv;
+  const double * const vof = solver->mesh->vof;
+  const double * const afn = af[n];
+  const long int irange = IRANGE, jmax = JMAX, kmax = KMAX;
+  const long int last[3] = { IMAX-2, JMAX-2, KMAX-2 };
+  long int i, j, k, l, ln, idx[3];
+  double *c, nu, scale, sum_fv;
+  int m;
+
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(i, j, k, l, ln, idx, c, nu, scale, sum_fv, m) schedule(static)
+  for(i=0; i<irange; i++) {
+    for(j=0; j<jmax; j++) {
+      for(k=0; k<kmax; k++) {
+        l = MESH_VIEW_OFFSET(view, i, j, k);
+        c = visc.coef + l * visc_count;
+        c[visc_diag] = 0;
+        visc.x[l] = vel_n[l];
+
+        /* the cells the predictor solved for */
+        idx[0] = i; idx[1] = j; idx[2] = k;
+        if(i < 1 || i > irange-2 || j < 1 || j > jmax-2 || k < 1 || k > kmax-2) continue;
+        if(fv[l] == 0.0 || afn[l] < solver->emf || idx[n] == last[n]) continue;
+        ln = l + off[n];
+        if(vof[l] + vof[ln] < solver->emf) continue;
+
+        if(solver->turbulence_nu != NULL) {
+          nu = (solver->turbulence_nu(solver,i,j,k) +
+                solver->turbulence_nu(solver,i+odim[n][0],j+odim[n][1],k+odim[n][2]))/2;
+        }
+        else
+          nu = solver->nu;
+
+        sum_fv = fv[l] + fv[ln];
+        scale = solver->delt * nu / (sum_fv / 2);
+
+        /* the faces of the explicit term, m == n along the component
+         * and the wall centred faces otherwise */
+        for(m=0; m<3; m++) {
+          c[2*m] = 0;
+          c[2*m+1] = 0;
+          if(m == n) {
+            if(afn[ln] > 0.01)
+              c[2*m] = (afn[l] + afn[ln]) / 2;
+            if(afn[l - off[n]] > 0.01)
+              c[2*m+1] = (afn[l] + afn[l - off[n]]) / 2;
+          }
+          else {
+            if(afn[l + off[m]] > 0.01)
+              c[2*m] = (af[m][l] + af[m][ln]) / 2;
+            if(afn[l - off[m]] > 0.01)
+              c[2*m+1] = (af[m][l - off[m]] + af[m][ln - off[m]]) / 2;
+          }
+          c[2*m] *= scale / pow(del[m],2);
+          c[2*m+1] *= scale / pow(del[m],2);
+        }
+
+        c[visc_diag] = 1 + c[visc_east] + c[visc_west] + c[visc_north] +
+                           c[visc_south] + c[visc_top] + c[visc_bottom];
+        c[visc_rhs] = vel[l];
+        visc.x[l] = vel[l];
+      }
+    }
+  }
+}
+
+/* solves the k-line of column (i, j) exactly, holding its i and j
+ * neighbours.  cp and d take kmax values each.  returns the largest change */
+static double vof_viscosity_line(struct solver_data *solver, long int i, long int j, double *cp, double *d) {
+  const struct mesh_view view = mesh_view(solver->mesh, solver->mesh->u);
+  const long int kmax = KMAX;
+  double * const x = visc.x;
+  const double *c;
+  double lower, upper, b, r, piv, change = 0;
+  long int k, l, base;
+
+  base = MESH_VIEW_OFFSET(view, i, j, 0);
+
+  /* forward elimination, cells not solved for are rows of the identity */
+  for(k=1; k<kmax-1; k++) {
+    l = base + k;
+    c = visc.coef + l * visc_count;
+
+    if(c[visc_diag] == 0) {
+      lower = 0;
+      upper = 0;
+      b = 1;
+      r = x[l];
+    }
+    else {
+      b = c[visc_diag];
+      r = c[visc_rhs] + c[visc_east]  * x[l + view.si] + c[visc_west]  * x[l - view.si] +
+                        c[visc_north] * x[l + view.sj] + c[visc_south] * x[l - view.sj];
+      lower = -c[visc_bottom];
+      upper = -c[visc_top];
+      if(visc.coef[(l-1) * visc_count + visc_diag] == 0) {
+        r -= lower * x[l-1];
+        lower = 0;
+      }
+      if(visc.coef[(l+1) * visc_count + visc_diag] == 0) {
+        r -= upper * x[l+1];
+        upper = 0;
+      }
+    }
+
+    piv = b;
+    if(k > 1) {
+      piv -= lower * cp[k-1];
+      r -= lower * d[k-1];
+    }
+    cp[k] = upper / piv;
+    d[k] = r / piv;
+  }
+
+  /* back substitution */
+  for(k=kmax-2; k>=1; k--) {
+    l = base + k;
+    r = d[k];
+    if(k < kmax-2) r -= cp[k] * x[l+1];
+    change = max(change, fabs(r - x[l]));
+    x[l] = r;
+  }
+
+  return change;
+}
+
+/* relaxes x until a sweep changes it by less than viscous_tol, returning
+ * the sweeps taken */
+static int vof_viscosity_solve(struct solver_data *solver, double *sweep_change) {
+  const long int irange = IRANGE, jmax = JMAX;
+  double change = 0, line_change, *cp;
+  long int i, j;
+  int colour, sweep;
+
+  for(sweep=1; sweep <= solver->viscous_iter; sweep++) {
+    change = 0;
+    for(colour=0; colour<2; colour++) {
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(i, j, cp, line_change) reduction(max:change) schedule(static)
+      for(i=1; i<irange-1; i++) {
+        if((i + ISTART) % 2 != colour) continue;
+        cp = visc.cp + 2 * KMAX * omp_get_thread_num();
+        for(j=1; j<jmax-1; j++) {
+          line_change = vof_viscosity_line(solver, i, j, cp, cp + KMAX);
+          change = max(change, line_change);
+        }
+      }
+    }
+
+    solver_sendrecv_edge(solver, visc.x);
+    change = solver_mpi_max(solver, change);
+    if(change < solver->viscous_tol) break;
+  }
+
+  *sweep_change = change;
+  return min(sweep, solver->viscous_iter);
+}
+
+int vof_viscosity_implicit(struct solver_data *solver) {
+  double * const vel[3] = { solver->mesh->u, solver->mesh->v, solver->mesh->w };
+  const double * const vel_n[3] = { mesh_n->u, mesh_n->v, mesh_n->w };
+  const long int size = IRANGE * JMAX * KMAX;
+  double change;
+  long int l;
+  int n, sweeps;
+
+  if(vof_viscosity_alloc(solver)) return 1;
+
+  solver->viscous_sweeps = 0;
+  for(n=0; n<3; n++) {
+    vof_viscosity_coef(solver, n, vel[n], vel_n[n]);
+    sweeps = vof_viscosity_solve(solver, &change);
+    solver->viscous_sweeps = max(solver->viscous_sweeps, sweeps);
+
+    if(change >= solver->viscous_tol && !solver->rank)
+      printf("warning: implicit viscous step of component %d stopped at a change of %e after %d sweeps\n",
+             n, change, sweeps);
+
+#pragma omp parallel for if(solver->threads > 1) num_threads(solver->threads) \
+    private(l) schedule(static)
+    for(l=0; l<size; l++)
+      if(visc.coef[l * visc_count + visc_diag] != 0) vel[n][l] = visc.x[l];
+  }
+
+  return 0;
+}
@@ -0,0 +1,13 @@
+/* vof_viscosity.h
+ *
+ * semi-implicit viscous step of the velocity predictor
+ */
+
+#ifndef VOF_VISCOSITY_H
+#define VOF_VISCOSITY_H
+
+#include "solver_data.h"
+
+int vof_viscosity_implicit(struct solver_data *solver);
+
+#endif
@@ -11,6 +11,7 @@
 #include "vtk.h"
 #include "vof_mpi.h"
 #include "solver.h"
+#include "solver_mpi.h"
 #include "mesh.h"
 #include "csv.h"
 #include "kE.h"
@@ -20,15 +21,19 @@
 
 
 int vof_vorticity(struct solver_data *solver) {
-  long int i,j,k;
+  long int i,j,k,irange;
   
-  if(solver->rank > 0) return 0;
+  /* ranks writing their own piece each work on their own slab, the upstream
+   * halo plane has no neighbour to difference against and is exchanged after */
+  if(solver->mesh->piece >= 0) irange = IRANGE;
+  else if(solver->rank > 0) return 0;
+  else irange = IMAX;
 
-  for(i=0; i<IMAX; i++) {
+  for(i=0; i<irange; i++) {
     for(j=0; j<JMAX; j++) {
       for(k=0; k<KMAX; k++) {
         
-        if(i == 0 || i==IMAX-1 || j==0 || j==JMAX-1 || k==0 || k==KMAX-1) {
+        if(i == 0 || i+ISTART==IMAX-1 || j==0 || j==JMAX-1 || k==0 || k==KMAX-1) {
           U_OMEGA(i,j,k)=0;
           V_OMEGA(i,j,k)=0;
           W_OMEGA(i,j,k)=0;
@@ -59,6 +64,12 @@ int vof_vorticity(struct solver_data *solver) {
       }
     }
   }
+
+  if(solver->mesh->piece >= 0) {
+    solver_sendrecv_edge(solver, solver->mesh->u_omega);
+    solver_sendrecv_edge(solver, solver->mesh->v_omega);
+    solver_sendrecv_edge(solver, solver->mesh->w_omega);
+  }
   
   return 0;
 }
\ No newline at end of file
@@ -90,6 +90,31 @@ int write_solver_xml(struct solver_data *solver, char *filename) {
 
   rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "abstol", "%e", solver->abstol);
   rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "reltol", "%e", solver->reltol);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "threads", "%d", solver->threads);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "distributed", "%d", solver->distributed);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "output_buffers", "%d", solver->output_buffers);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "output_drop", "%d", solver->output_drop);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "vtk_compression", "%d", solver->vtk_compression);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "vtk_raw", "%d", solver->vtk_raw);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "vtk_float32", "%d", solver->vtk_float32);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "pressure_pc", "%d", solver->pressure_pc);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "pressure_ksp", "%d", solver->pressure_ksp);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "pressure_line_gs", "%d", solver->pressure_line_gs);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "pressure_line_smoother", "%d", solver->pressure_line_smoother);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "pressure_pc_single", "%d", solver->pressure_pc_single);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "pressure_matrix_free", "%d", solver->pressure_matrix_free);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "pressure_pc_reuse", "%d", solver->pressure_pc_reuse);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "pressure_pc_reuse_iter", "%d", solver->pressure_pc_reuse_iter);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "pressure_pc_reuse_changed", "%e", solver->pressure_pc_reuse_changed);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "pressure_warm_start", "%d", solver->pressure_warm_start);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "pressure_active_only", "%d", solver->pressure_active_only);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "viscous_implicit", "%d", solver->viscous_implicit);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "viscous_iter", "%d", solver->viscous_iter);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "viscous_tol", "%e", solver->viscous_tol);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "balance", "%d", solver->balance);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "balance_fluid", "%e", solver->balance_fluid);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "balance_limit", "%e", solver->balance_limit);
+  rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "checkpointt", "%e", solver->checkpointt);
 
   rc = xmlTextWriterStartElement(writer, BAD_CAST "Gravity");
   rc = xmlTextWriterWriteFormatElement(writer, BAD_CAST "x", "%e", solver->gx);